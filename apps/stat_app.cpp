@@ -1,4 +1,6 @@
 #include "DataFrame.hpp"
+#include "Profiler.hpp"
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
 
@@ -17,6 +19,11 @@ int main(int argc, char* argv[])
         std::string out_dir_name="../../output/";
         std::string out_file_name=argv[2];
 
+        // time the operations if a report (SCI_PROFILE) or a trace (SCI_TRACE) is requested
+        const char* profile_file = std::getenv("SCI_PROFILE");
+        const char* trace_file = std::getenv("SCI_TRACE");
+        Profiler::enable(profile_file != nullptr || trace_file != nullptr);
+
         // Open a file for writing
         std::ofstream file(out_dir_name+out_file_name);
         // Check if the output file is opened correctly
@@ -114,6 +121,13 @@ int main(int argc, char* argv[])
         // Restore the original standard output
         std::cout.rdbuf(original_buffer);
         std::cout<<out_file_name<<" SAVED SUCCESFULLY IN "<<out_dir_name<<std::endl;
+
+        if (profile_file != nullptr) {
+            Profiler::write_json(profile_file);
+        }
+        if (trace_file != nullptr) {
+            Profiler::write_chrome_trace(trace_file);
+        }
     }
     catch(const std::exception& e)
     {
@@ -0,0 +1,128 @@
+#ifndef BENCH_UTILS_HPP
+#define BENCH_UTILS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+
+// Helpers shared by the benchmarks: timing, peak memory and the JSON report
+
+namespace bench {
+
+// one measured operation
+struct Result {
+    std::string benchmark;
+    std::size_t rows{0};
+    std::size_t columns{0};
+    double seconds{0.0};        // best time over the repetitions
+    double mean_seconds{0.0};
+    std::size_t bytes{0};       // bytes processed by one repetition (file or in-memory size)
+    std::size_t peak_rss_bytes{0};
+};
+
+// discard everything written to it, after formatting (unlike a stream in failed state)
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// restart the measure of the peak resident memory (Linux only, ignored elsewhere)
+inline void reset_peak_rss()
+{
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    if (clear_refs) {
+        clear_refs << "5";
+    }
+}
+
+// highest resident memory since the last reset_peak_rss(), in bytes
+inline std::size_t peak_rss_bytes()
+{
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key) {
+        if (key == "VmHWM:") {
+            std::size_t kb{0};
+            status >> kb;
+            return kb * 1024;
+        }
+        status.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    // peak of the whole process
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
+// run setup() then f() `repeat` times, timing only f(); the output of f() is discarded
+inline Result measure(const std::string& benchmark, int repeat,
+                      const std::function<void()>& setup, const std::function<void()>& f)
+{
+    Result result;
+    result.benchmark = benchmark;
+    result.seconds = std::numeric_limits<double>::infinity();
+
+    NullBuffer null_buffer;
+    std::streambuf* original_buffer = std::cout.rdbuf();
+    reset_peak_rss();
+    double total{0.0};
+    for (int k = 0; k < repeat; ++k) {
+        setup();
+        std::cout.rdbuf(&null_buffer);
+        auto start = std::chrono::steady_clock::now();
+        try {
+            f();
+        } catch (...) {
+            std::cout.rdbuf(original_buffer);
+            throw;
+        }
+        auto end = std::chrono::steady_clock::now();
+        std::cout.rdbuf(original_buffer);
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        result.seconds = std::min(result.seconds, seconds);
+        total += seconds;
+    }
+    result.mean_seconds = total / std::max(repeat, 1);
+    result.peak_rss_bytes = peak_rss_bytes();
+    return result;
+}
+
+// write the results as a JSON object, with the throughput of the best repetition
+inline void write_json(std::ostream& out, const std::vector<std::pair<std::string, std::string>>& config,
+                       const std::vector<Result>& results)
+{
+    out << std::setprecision(10) << "{\n  \"config\": {";
+    for (std::size_t i = 0; i < config.size(); ++i) {
+        out << (i == 0 ? "" : ", ") << "\"" << config[i].first << "\": " << config[i].second;
+    }
+    out << "},\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        double seconds = std::max(r.seconds, 1e-12);
+        out << "    {\"benchmark\": \"" << r.benchmark << "\""
+            << ", \"rows\": " << r.rows
+            << ", \"columns\": " << r.columns
+            << ", \"seconds\": " << r.seconds
+            << ", \"mean_seconds\": " << r.mean_seconds
+            << ", \"rows_per_s\": " << r.rows / seconds
+            << ", \"bytes\": " << r.bytes
+            << ", \"bytes_per_s\": " << r.bytes / seconds
+            << ", \"peak_rss_bytes\": " << r.peak_rss_bytes << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+} // namespace bench
+
+#endif // BENCH_UTILS_HPP
@@ -0,0 +1,289 @@
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BenchUtils.hpp"
+#include "DataFrame.hpp"
+
+// Benchmarks of the DataFrame on reproducible synthetic tables.
+//
+// usage: dataframe_bench [--rows 1000,10000,100000] [--cols 8] [--null-ratio 0.01]
+//                        [--cardinality 16] [--seed 42] [--repeat 3]
+//                        [--max-json-rows 1000000] [--workdir dir] [--output results.json]
+//
+// Every table has `cols` numeric columns num_0, num_1, ... (normal values with three
+// decimals, a fraction `null-ratio` of them missing) and a string column `category`
+// taking `cardinality` distinct values. The results are printed as JSON.
+
+struct Config {
+    std::vector<std::size_t> rows{1000, 10000, 100000};
+    std::size_t cols{8};
+    double null_ratio{0.01};
+    std::size_t cardinality{16};
+    unsigned long seed{42};
+    int repeat{3};
+    std::size_t max_json_rows{1000000};
+    std::string workdir{std::filesystem::temp_directory_path().string()};
+    std::string output;
+};
+
+// the cells of a table, generated row by row from the seed
+class TableGenerator {
+public:
+    explicit TableGenerator(const Config& config)
+        : config(config), engine(config.seed), category(0, config.cardinality - 1) {}
+
+    // fill the cells of the next row, an empty cell is a null
+    void next_row(std::vector<std::string>& cells)
+    {
+        cells.resize(config.cols + 1);
+        for (std::size_t col = 0; col < config.cols; ++col) {
+            cells[col].clear();
+            if (uniform(engine) < config.null_ratio) {
+                continue;
+            }
+            // a different location and scale for every column
+            double value = 10.0 * col + (1.0 + col) * normal(engine);
+            char buffer[32];
+            char* end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 3).ptr;
+            cells[col].assign(buffer, end);
+        }
+        cells[config.cols] = "cat_" + std::to_string(category(engine));
+    }
+
+private:
+    const Config& config;
+    std::mt19937_64 engine;
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+    std::normal_distribution<double> normal{0.0, 1.0};
+    std::uniform_int_distribution<std::size_t> category;
+};
+
+std::vector<std::string> column_names(const Config& config)
+{
+    std::vector<std::string> names;
+    for (std::size_t col = 0; col < config.cols; ++col) {
+        names.push_back("num_" + std::to_string(col));
+    }
+    names.push_back("category");
+    return names;
+}
+
+// write a table of n_rows rows as CSV, return the size of the file
+std::size_t write_synthetic_csv(const std::string& filename, const Config& config, std::size_t n_rows)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    auto names = column_names(config);
+    std::string line;
+    for (std::size_t col = 0; col < names.size(); ++col) {
+        line += (col > 0 ? "," : "") + names[col];
+    }
+    line += '\n';
+
+    TableGenerator generator(config);
+    std::vector<std::string> cells;
+    for (std::size_t row = 0; row < n_rows; ++row) {
+        generator.next_row(cells);
+        for (std::size_t col = 0; col < cells.size(); ++col) {
+            if (col > 0) {
+                line += ',';
+            }
+            line += cells[col];
+        }
+        line += '\n';
+        if (line.size() > (1 << 20)) {
+            file << line;
+            line.clear();
+        }
+    }
+    file << line;
+    return static_cast<std::size_t>(file.tellp());
+}
+
+// write the same table as a JSON array of objects, the nulls as JSON null
+std::size_t write_synthetic_json(const std::string& filename, const Config& config, std::size_t n_rows)
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    auto names = column_names(config);
+    std::string line = "[\n";
+
+    TableGenerator generator(config);
+    std::vector<std::string> cells;
+    for (std::size_t row = 0; row < n_rows; ++row) {
+        generator.next_row(cells);
+        line += row > 0 ? ",\n{" : "{";
+        for (std::size_t col = 0; col < cells.size(); ++col) {
+            line += (col > 0 ? ",\"" : "\"") + names[col] + "\":";
+            if (cells[col].empty()) {
+                line += "null";
+            } else if (col < config.cols) {
+                line += cells[col];
+            } else {
+                line += '"' + cells[col] + '"';
+            }
+        }
+        line += '}';
+        if (line.size() > (1 << 20)) {
+            file << line;
+            line.clear();
+        }
+    }
+    file << line << "\n]\n";
+    return static_cast<std::size_t>(file.tellp());
+}
+
+std::vector<std::size_t> parse_sizes(const std::string& list)
+{
+    std::vector<std::size_t> sizes;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        // accept the scientific notation, e.g. 1e6
+        sizes.push_back(static_cast<std::size_t>(std::stod(item)));
+    }
+    return sizes;
+}
+
+Config parse_arguments(int argc, char* argv[])
+{
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for argument " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--rows") {
+            config.rows = parse_sizes(value);
+        } else if (arg == "--cols") {
+            config.cols = std::stoul(value);
+        } else if (arg == "--null-ratio") {
+            config.null_ratio = std::stod(value);
+        } else if (arg == "--cardinality") {
+            config.cardinality = std::max<std::size_t>(1, std::stoul(value));
+        } else if (arg == "--seed") {
+            config.seed = std::stoul(value);
+        } else if (arg == "--repeat") {
+            config.repeat = std::max(1, std::stoi(value));
+        } else if (arg == "--max-json-rows") {
+            config.max_json_rows = static_cast<std::size_t>(std::stod(value));
+        } else if (arg == "--workdir") {
+            config.workdir = value;
+        } else if (arg == "--output") {
+            config.output = value;
+        } else {
+            throw std::invalid_argument("Unknown argument " + arg);
+        }
+    }
+    if (config.cols == 0) {
+        throw std::invalid_argument("At least one numeric column is needed.");
+    }
+    return config;
+}
+
+// in-memory size of a dataframe
+std::size_t frame_bytes(const DataFrame& df)
+{
+    std::size_t bytes{0};
+    for (std::size_t column_bytes : df.memory_usage()) {
+        bytes += column_bytes;
+    }
+    return bytes;
+}
+
+void run_benchmarks(const Config& config, std::size_t n_rows, std::vector<bench::Result>& results)
+{
+    std::string base = (std::filesystem::path(config.workdir) / ("synthetic_" + std::to_string(n_rows))).string();
+    std::string csv_name = base + ".csv";
+    std::string json_name = base + ".json";
+    std::size_t csv_bytes = write_synthetic_csv(csv_name, config, n_rows);
+
+    auto names = column_names(config);
+    std::vector<std::string> numeric(names.begin(), names.end() - 1);
+    auto nothing = []() {};
+
+    auto add = [&](bench::Result result, std::size_t bytes) {
+        result.rows = n_rows;
+        result.columns = names.size();
+        result.bytes = bytes;
+        results.push_back(result);
+        std::cerr << result.benchmark << " (" << n_rows << " rows): " << result.seconds << " s\n";
+    };
+
+    DataFrame df;
+    add(bench::measure("read_csv", config.repeat, nothing, [&]() { df.read_csv(csv_name); }), csv_bytes);
+
+    if (n_rows <= config.max_json_rows) {
+        std::size_t json_bytes = write_synthetic_json(json_name, config, n_rows);
+        DataFrame from_json;
+        add(bench::measure("read_json", config.repeat, nothing, [&]() { from_json.read_json(json_name); }), json_bytes);
+        std::filesystem::remove(json_name);
+    }
+    std::filesystem::remove(csv_name);
+
+    std::size_t bytes = frame_bytes(df);
+    add(bench::measure("summary", config.repeat, nothing, [&]() { df.summary(); }), bytes);
+    add(bench::measure("quantile", config.repeat, nothing, [&]() {
+        for (const auto& name : numeric) {
+            df.quantile(name, 0.9);
+        }
+    }), bytes);
+    add(bench::measure("table", config.repeat, nothing, [&]() { df.table("category"); }), bytes);
+    add(bench::measure("histogram", config.repeat, nothing, [&]() { df.histogram("num_0"); }), bytes);
+
+    // drop_row_nan changes the frame, each repetition works on a fresh copy
+    DataFrame copy;
+    add(bench::measure("drop_row_nan", config.repeat, [&]() { copy = df; }, [&]() { copy.drop_row_nan(); }), bytes);
+
+    // pairwise-complete: the nulls of a column only drop the rows of its pairs
+    add(bench::measure("correlation_matrix", config.repeat, nothing, [&]() { df.correlation_matrix(numeric); }), bytes);
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        Config config = parse_arguments(argc, argv);
+
+        std::vector<bench::Result> results;
+        for (std::size_t n_rows : config.rows) {
+            run_benchmarks(config, n_rows, results);
+        }
+
+        std::vector<std::pair<std::string, std::string>> parameters = {
+            {"cols", std::to_string(config.cols)},
+            {"null_ratio", std::to_string(config.null_ratio)},
+            {"cardinality", std::to_string(config.cardinality)},
+            {"seed", std::to_string(config.seed)},
+            {"repeat", std::to_string(config.repeat)},
+        };
+        if (config.output.empty()) {
+            bench::write_json(std::cout, parameters, results);
+        } else {
+            std::ofstream file(config.output);
+            if (!file.is_open()) {
+                throw std::runtime_error("Could not open file: " + config.output);
+            }
+            bench::write_json(file, parameters, results);
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BenchUtils.hpp"
+#include "LinearInterpolator.hpp"
+
+// Benchmarks of the LinearInterpolator on reproducible lookup tables.
+//
+// usage: interpolation_bench [--nodes 1000,100000,1000000] [--queries 1000000]
+//                            [--seed 42] [--repeat 3] [--max-scan-work 1e9]
+//                            [--output results.json]
+//
+// Every table is built twice, on equally spaced nodes and on nodes with random
+// gaps, with y = sin(x). The queries are uniform random points of the range,
+// evaluated one by one with operator() and, sorted, in one call to evaluate()
+// and to evaluate_parallel().
+// The same queries go through a copy of the previous implementation (a linear
+// scan of the nodes for every point, and a walk from the previous interval for
+// the sorted points) to measure the speedup. The scan costs nodes x queries:
+// it is run on the first max-scan-work / nodes queries only, which the `rows`
+// of its results tell. In the results, `rows` is the number of queries and
+// `columns` the number of nodes. The results are printed as JSON.
+
+struct Config {
+    std::vector<std::size_t> nodes{1000, 100000, 1000000};
+    std::size_t queries{1000000};
+    unsigned long seed{42};
+    int repeat{3};
+    double max_scan_work{1e9};
+    std::string output;
+};
+
+// the previous LinearInterpolator, kept as the reference of the benchmark
+class ScanInterpolator {
+public:
+    ScanInterpolator(const std::vector<double>& x, const std::vector<double>& y) : x_nodes(x), y_nodes(y) {}
+
+    double operator()(double x) const
+    {
+        for (std::size_t i = 0; i < x_nodes.size() - 1; ++i) {
+            if (x >= x_nodes[i] && x <= x_nodes[i + 1]) {
+                double slope = (y_nodes[i + 1] - y_nodes[i]) / (x_nodes[i + 1] - x_nodes[i]);
+                return y_nodes[i] + slope * (x - x_nodes[i]);
+            }
+        }
+        throw std::runtime_error("Interpolation failed. x should be within the data range.");
+    }
+
+    void evaluate(const double* xs, double* out, std::size_t n) const
+    {
+        std::size_t i = 0;
+        for (std::size_t k = 0; k < n; ++k) {
+            double x = xs[k];
+            if (x < x_nodes[i]) {
+                i = 0;
+            }
+            while (x > x_nodes[i + 1]) {
+                ++i;
+            }
+            double slope = (y_nodes[i + 1] - y_nodes[i]) / (x_nodes[i + 1] - x_nodes[i]);
+            out[k] = y_nodes[i] + slope * (x - x_nodes[i]);
+        }
+    }
+
+private:
+    std::vector<double> x_nodes;
+    std::vector<double> y_nodes;
+};
+
+std::vector<std::size_t> parse_sizes(const std::string& list)
+{
+    std::vector<std::size_t> sizes;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        // accept the scientific notation, e.g. 1e6
+        sizes.push_back(static_cast<std::size_t>(std::stod(item)));
+    }
+    return sizes;
+}
+
+Config parse_arguments(int argc, char* argv[])
+{
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for argument " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--nodes") {
+            config.nodes = parse_sizes(value);
+        } else if (arg == "--queries") {
+            config.queries = static_cast<std::size_t>(std::stod(value));
+        } else if (arg == "--seed") {
+            config.seed = std::stoul(value);
+        } else if (arg == "--repeat") {
+            config.repeat = std::max(1, std::stoi(value));
+        } else if (arg == "--max-scan-work") {
+            config.max_scan_work = std::stod(value);
+        } else if (arg == "--output") {
+            config.output = value;
+        } else {
+            throw std::invalid_argument("Unknown argument " + arg);
+        }
+    }
+    for (std::size_t n_nodes : config.nodes) {
+        if (n_nodes < 2) {
+            throw std::invalid_argument("At least two nodes are needed.");
+        }
+    }
+    if (config.queries == 0) {
+        throw std::invalid_argument("At least one query is needed.");
+    }
+    return config;
+}
+
+// n_nodes increasing nodes on [0, n_nodes - 1], equally spaced or with random gaps
+std::vector<double> make_nodes(std::size_t n_nodes, bool uniform, std::mt19937_64& engine)
+{
+    std::vector<double> x(n_nodes);
+    std::uniform_real_distribution<double> gap(0.1, 1.9);
+    for (std::size_t i = 0; i < n_nodes; ++i) {
+        x[i] = uniform || i == 0 ? static_cast<double>(i) : x[i - 1] + gap(engine);
+    }
+    // the same range for both layouts
+    double scale = static_cast<double>(n_nodes - 1) / x.back();
+    for (double& value : x) {
+        value *= scale;
+    }
+    x.back() = static_cast<double>(n_nodes - 1);
+    return x;
+}
+
+void run_benchmarks(const Config& config, std::size_t n_nodes, bool uniform, std::vector<bench::Result>& results)
+{
+    std::mt19937_64 engine(config.seed);
+    std::vector<double> x = make_nodes(n_nodes, uniform, engine);
+    std::vector<double> y(n_nodes);
+    for (std::size_t i = 0; i < n_nodes; ++i) {
+        y[i] = std::sin(x[i]);
+    }
+    std::uniform_real_distribution<double> point(x.front(), x.back());
+    std::vector<double> queries(config.queries);
+    for (double& q : queries) {
+        q = point(engine);
+    }
+    std::vector<double> sorted = queries;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<double> out(config.queries);
+
+    std::size_t scanned = static_cast<std::size_t>(config.max_scan_work / static_cast<double>(n_nodes));
+    scanned = std::clamp<std::size_t>(scanned, 1, config.queries);
+
+    const std::string layout = uniform ? "uniform" : "nonuniform";
+    auto nothing = []() {};
+    auto add = [&](bench::Result result, std::size_t n_queries) {
+        result.benchmark += "_" + layout;
+        result.rows = n_queries;
+        result.columns = n_nodes;
+        result.bytes = 2 * n_queries * sizeof(double);
+        results.push_back(result);
+        std::cerr << result.benchmark << " (" << n_nodes << " nodes): " << result.seconds << " s\n";
+    };
+
+    // the sums are written to the discarded std::cout so that nothing is optimised away
+    ScanInterpolator scan(x, y);
+    add(bench::measure("scan", config.repeat, nothing, [&]() {
+        double sum{0.0};
+        for (std::size_t k = 0; k < scanned; ++k) {
+            sum += scan(queries[k]);
+        }
+        std::cout << sum;
+    }), scanned);
+
+    LinearInterpolator linear(x, y);
+    add(bench::measure("lookup", config.repeat, nothing, [&]() {
+        double sum{0.0};
+        for (double q : queries) {
+            sum += linear(q);
+        }
+        std::cout << sum;
+    }), config.queries);
+
+    add(bench::measure("walk_sorted", config.repeat, nothing, [&]() {
+        scan.evaluate(sorted.data(), out.data(), sorted.size());
+        std::cout << out.back();
+    }), config.queries);
+
+    add(bench::measure("evaluate_sorted", config.repeat, nothing, [&]() {
+        linear.evaluate(sorted.data(), out.data(), sorted.size());
+        std::cout << out.back();
+    }), config.queries);
+
+    add(bench::measure("evaluate_parallel_sorted", config.repeat, nothing, [&]() {
+        linear.evaluate_parallel(sorted.data(), out.data(), sorted.size());
+        std::cout << out.back();
+    }), config.queries);
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        Config config = parse_arguments(argc, argv);
+
+        std::vector<bench::Result> results;
+        for (std::size_t n_nodes : config.nodes) {
+            run_benchmarks(config, n_nodes, true, results);
+            run_benchmarks(config, n_nodes, false, results);
+        }
+
+        std::vector<std::pair<std::string, std::string>> parameters = {
+            {"queries", std::to_string(config.queries)},
+            {"seed", std::to_string(config.seed)},
+            {"repeat", std::to_string(config.repeat)},
+        };
+        if (config.output.empty()) {
+            bench::write_json(std::cout, parameters, results);
+        } else {
+            std::ofstream file(config.output);
+            if (!file.is_open()) {
+                throw std::runtime_error("Could not open file: " + config.output);
+            }
+            bench::write_json(file, parameters, results);
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef ALLOCATION_TRACKER_HPP
+#define ALLOCATION_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+
+// Opt-in accounting of the heap allocations made by the DataFrame operations.
+// The counting replaces the global operator new/delete, so it is compiled only
+// when the library is built with -DTRACK_ALLOCATIONS=ON: otherwise available()
+// is false and nothing is ever recorded. When compiled in, it is still off
+// until enable(true) is called.
+class AllocationTracker {
+public:
+    // what an operation allocated, summed over all its calls
+    struct Stats {
+        std::size_t calls{0};
+        std::size_t allocations{0};
+        std::size_t bytes{0};           // bytes allocated (freed ones included)
+        std::size_t peak_bytes{0};      // largest growth of the live heap during a call
+    };
+
+    // true if the library was built with the allocation counting
+    static bool available();
+
+    // switch the counting on or off at run time
+    static void enable(bool on);
+
+    static bool enabled();
+
+    // bytes currently allocated since the counting was enabled
+    static std::int64_t live_bytes();
+
+    // statistics of every operation recorded so far
+    static std::map<std::string, Stats> report();
+
+    // forget the recorded statistics
+    static void reset();
+
+    // print the report as a table
+    static void print(std::ostream& out = std::cout);
+
+    // records the allocations made by the calling thread while it is alive
+    // under the name of an operation. Scopes can be nested, and scopes open at
+    // the same time on several threads (e.g. the parsers of Dataset::read)
+    // each count their own thread only; the allocations of helper threads,
+    // such as the workers of write_csv or the decompression thread of the
+    // readers, are not included
+    class Scope {
+    public:
+        explicit Scope(const char* operation);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* operation;
+        bool active;
+        std::size_t start_allocations{0};
+        std::size_t start_bytes{0};
+        std::int64_t start_live{0};
+        std::int64_t saved_peak{0};
+    };
+};
+
+#endif // ALLOCATION_TRACKER_HPP
@@ -0,0 +1,62 @@
+#ifndef BARYCENTRIC_INTERPOLATOR_HPP
+#define BARYCENTRIC_INTERPOLATOR_HPP
+
+#include "Interpolator.hpp"
+#include <cstddef>
+#include <functional>
+
+// Polynomial interpolation with the second (true) barycentric formula
+//
+//     p(x) = sum_j w_j y_j / (x - x_j) / sum_j w_j / (x - x_j)
+//
+// which is evaluated in O(n) and stays stable for thousands of nodes, as long
+// as the nodes cluster at the ends of the range like the Chebyshev points (on
+// equally spaced nodes high degrees are ill-conditioned whatever the formula).
+class BarycentricInterpolator : public Interpolator {
+public:
+    // Any strictly increasing nodes: the weights are computed in O(n^2)
+    BarycentricInterpolator(const std::vector<double>& x, const std::vector<double>& y);
+
+    // The n Chebyshev points of the second kind on [a, b], in increasing
+    // order and including a and b
+    static std::vector<double> chebyshev_nodes(double a, double b, std::size_t n);
+
+    // Interpolator on chebyshev_nodes(a, b, y.size()), y being the values at
+    // these nodes: the weights are known in closed form, O(n)
+    static BarycentricInterpolator chebyshev(double a, double b, const std::vector<double>& y);
+
+    // Same, sampling f at n nodes
+    static BarycentricInterpolator chebyshev(double a, double b, std::size_t n, const std::function<double(double)>& f);
+
+    // Interpolation at x, exact at the nodes
+    double operator()(double x) const override;
+
+    void evaluate(const double* xs, double* out, std::size_t n) const override;
+    using Interpolator::evaluate;
+
+    // The interpolating polynomial, expanded around the left node of each interval
+    PiecewisePolynomial to_piecewise() const override;
+
+    // Adds the node (x, y), updating the weights in O(n); x may lie outside
+    // the current range, which grows accordingly
+    void add_node(double x, double y);
+
+    // The barycentric weights, in the order of the nodes (scaled by a common factor)
+    const std::vector<double>& get_weights() const { return weights; }
+
+private:
+    // nodes already validated and weights already computed
+    BarycentricInterpolator(std::vector<double> x, std::vector<double> y, std::vector<double> w, double scale);
+
+    void compute_weights();
+
+    // the second formula at a point which is not a node
+    double barycentric_sum(double x) const;
+
+    std::vector<double> weights;
+    // the differences between nodes are divided by a quarter of the initial
+    // range, so that the products of the weights neither overflow nor underflow
+    double scale{1.0};
+};
+
+#endif // BARYCENTRIC_INTERPOLATOR_HPP
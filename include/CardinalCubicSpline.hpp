@@ -15,6 +15,13 @@ class CardinalCubicSpline : public Interpolator {
     // Method for evaluating interpolation
     double operator()(double x) const override;
 
+    // The spline finds the interval of a point by a division: no search to save
+    void evaluate(const double* xs, double* out, std::size_t n) const override;
+    using Interpolator::evaluate;
+
+    // Degree 3, from the value and the derivatives of the spline at the nodes
+    PiecewisePolynomial to_piecewise() const override;
+
 private:
     // Method to check if the steps between nodes are equal
     void check_steps(const std::vector<double>& x) const;
@@ -0,0 +1,45 @@
+#ifndef CUBIC_SPLINE_HPP
+#define CUBIC_SPLINE_HPP
+
+#include "Interpolator.hpp"
+#include "IntervalSearch.hpp"
+#include <cstddef>
+
+// Cubic spline on any strictly increasing nodes, built in O(n) by solving the
+// tridiagonal system of the second derivatives at the nodes
+class CubicSpline : public Interpolator {
+public:
+    // Conditions at the two ends of the range
+    enum class Boundary {
+        Natural,    // zero second derivative
+        Clamped,    // given first derivative, left_slope and right_slope
+        NotAKnot    // continuous third derivative at the second and last but one nodes
+    };
+
+    CubicSpline(const std::vector<double>& x, const std::vector<double>& y,
+                Boundary boundary = Boundary::Natural, double left_slope = 0.0, double right_slope = 0.0);
+
+    // O(1) for equally spaced nodes, O(log n) otherwise
+    double operator()(double x) const override;
+
+    // Walks the intervals forward on sorted points
+    void evaluate(const double* xs, double* out, std::size_t n) const override;
+    using Interpolator::evaluate;
+
+    // Degree 3: the coefficients of the segments
+    PiecewisePolynomial to_piecewise() const override;
+
+private:
+    // s(x) = a + t (b + t (c + t d)), t = x - x_i, on [x_i, x_{i+1}]: the four
+    // coefficients of an interval are next to each other in memory
+    struct Segment {
+        double a, b, c, d;
+    };
+
+    void compute_coefficients(Boundary boundary, double left_slope, double right_slope);
+
+    std::vector<Segment> segments;
+    IntervalSearch search;
+};
+
+#endif // CUBIC_SPLINE_HPP
@@ -1,25 +1,143 @@
 #ifndef DATAFRAME_HPP
 #define DATAFRAME_HPP
 
+#include <istream>
 #include <string>
 #include <vector>
 #include <variant>
 #include <optional>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include "ArrowInterface.hpp"
+#include "DataTypes.hpp"
+#include "EncodedColumn.hpp"
+#include "Rolling.hpp"
+
+// methods available to fill the missing values of a numeric column
+enum class FillMethod {
+    Linear,     // piecewise linear interpolation between the valid values
+    Spline      // natural cubic spline through the valid values
+};
 
-using DataType = std::variant<double, std::string>;
-using ColumnType = std::vector<std::optional<DataType>>;
+// statistics that can be bootstrapped
+enum class Statistic {
+    Mean,
+    Median,
+    Correlation     // between two columns
+};
+
+// statistic of every pair of some columns, each computed on the rows where
+// both columns are valid (pairwise-complete)
+struct PairwiseMatrix {
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> values;        // nan for a pair with less than two rows
+    std::vector<std::vector<std::size_t>> counts;   // rows used by each pair
+};
 
 class DataFrame
 {   
     
 private:
     std::vector<std::string> column_names;
-    std::vector<ColumnType> data;
+    // hash index from the column name to its position (first occurrence wins)
+    std::unordered_map<std::string, std::size_t> column_index;
+    // arena owning the characters of the string cells created by the readers:
+    // it hands out memory from large blocks and releases them all at once,
+    // every buffer created by share_column keeps it alive
+    std::shared_ptr<std::pmr::monotonic_buffer_resource> string_pool;
+    // the cells of every column, shared with the copies of the dataframe and
+    // never changed while shared (copy-on-write, see mutable_column)
+    std::vector<ColumnBuffer> data;
+    // compressed form of the encoded columns (null for the plain ones), shared
+    // as the cells: the cells of an encoded column are released, its buffer is empty
+    std::vector<std::shared_ptr<const EncodedColumn>> encoded;
+
+    // replace the string arena with a fresh one, the buffers already created
+    // keep the previous one
+    void reset_string_pool();
+
+    // move the cells into a new buffer, which keeps the current string arena alive
+    ColumnBuffer share_column(ColumnType cells) const;
+
+    // cells of a column that can be changed: the buffer is copied first
+    // if another dataframe shares it, or if it was not created by share_column
+    ColumnType& mutable_column(std::size_t idx);
+
+    // fill an empty dataframe from CSV or JSON input, for read_csv and read_json
+    void parse_csv(std::istream& input, char separator, bool has_header);
+    void parse_json(std::istream& input);
+
+    // rebuild the name index from column_names
+    void build_index();
+
+    // number of rows, also when the first column is encoded
+    std::size_t n_rows() const;
+
+    // the methods changing the cells decode the column first and then encode
+    // it again with the encoding returned by decode_for_update (or with the
+    // best one, if the new values do not fit that encoding any more)
+    std::optional<ColumnEncoding> decode_for_update(std::size_t idx);
+    void restore_encoding(std::size_t idx, std::optional<ColumnEncoding> encoding);
+
+    // decode_for_update on construction and restore_encoding on destruction,
+    // so that an exception does not leave the column decoded
+    class UpdateGuard {
+    public:
+        UpdateGuard(DataFrame& frame, std::size_t idx);
+        ~UpdateGuard() noexcept(false);
+
+        UpdateGuard(const UpdateGuard&) = delete;
+        UpdateGuard& operator=(const UpdateGuard&) = delete;
+
+    private:
+        DataFrame& frame;
+        std::size_t idx;
+        std::optional<ColumnEncoding> encoding;
+        int exceptions;     // in flight at construction
+    };
+
+    // pointer to the cell of row `begin` of every column, the encoded columns
+    // are decoded in `decoded` for the rows [begin, end)
+    std::vector<const std::optional<DataType>*> block_cells(std::size_t begin, std::size_t end, std::vector<ColumnType>& decoded) const;
+
+    // values of a numeric column as optional doubles (NaN as null), decoding it if needed;
+    // throw if the column holds strings
+    std::vector<std::optional<double>> optional_values(std::size_t idx, const std::string& function) const;
+
+    // values of a numeric column as dense arrays for the loops over aligned rows:
+    // a null is stored as 0 with a weight of 0, a valid value with a weight of 1;
+    // throw if the column holds strings
+    void dense_values(std::size_t idx, const std::string& function, std::vector<double>& values, std::vector<double>& weights) const;
+
+    // covariances (correlation false) or correlations of the pairs of columns
+    PairwiseMatrix pairwise(const std::vector<std::string>& names, bool correlation, const std::string& function) const;
 public:
+    // reference to a column by position, obtained once with get_handle() and then
+    // used in hot loops to skip the name lookup; it is invalidated when columns
+    // are added, dropped or renamed
+    struct ColumnHandle {
+        std::size_t index;
+    };
+
     DataFrame() = default; 
     ~DataFrame() = default;
 
+    // a copy shares the column buffers, so it costs O(columns) whatever the number
+    // of rows; a buffer is copied only when one of the dataframes changes it. A copy
+    // is therefore a cheap snapshot, that another thread can read while this
+    // dataframe keeps being changed
+    DataFrame(const DataFrame& other) = default;
+    DataFrame(DataFrame&& other) noexcept = default;
+
+    // assignment swaps the whole storage, so that no cell is ever assigned
+    // into memory belonging to an arena that is about to be released
+    DataFrame& operator=(DataFrame other) noexcept;
+
+    void swap(DataFrame& other) noexcept;
+
     /* ---------------------------------------------------------------------- */
     /*                         DATA STRUCTURE METHODS                         */
     /* ---------------------------------------------------------------------- */
@@ -28,23 +146,54 @@ public:
     // contains the header or not (if not it will provide a default header: Col1, Col2, ...)
     void read_csv(const std::string& filename, char separator = ',', bool has_header = true);
 
+    // read CSV data from any stream, e.g. a file already loaded in memory.
+    // Fields in double quotes may contain the separator, newlines and doubled
+    // quotes (the quoting of write_csv)
+    void read_csv(std::istream& input, char separator = ',', bool has_header = true);
+
     // read from JSON file, passing the filename (with the extension)
     void read_json(const std::string& filename);
 
-    // return data of the dataset (without the header)
-    const std::vector<ColumnType>& get_data() const;
+    // read JSON data from any stream
+    void read_json(std::istream& input);
+
+    // write to CSV file, with the header on the first line and the null cells left empty
+    void write_csv(const std::string& filename, char separator = ',') const;
+
+    // write to JSON file as an array of objects (the layout read by read_json),
+    // or as newline-delimited JSON with one object per line if ndjson is true
+    void write_json(const std::string& filename, bool ndjson = false) const;
+
+    // return data of the dataset (without the header), as the buffers of the columns:
+    // they can be kept, they are never changed once shared. The encoded columns
+    // are decoded once, as by get_column
+    std::vector<ColumnBuffer> get_data() const;
 
     // return the pair: number of rows, number of columns
     std::pair<unsigned int,unsigned int> shape() const;
 
-    // return the data from a particular column, passing the index (number)
+    // return the data from a particular column, passing the index (number); an
+    // encoded column is decoded on the first call and its cells kept with it
     const ColumnType& get_column(const size_t column) const;
 
     // return the header of the dataframe
     const std::vector<std::string>& get_header() const;
     
     // insert a column in the dataset, passing the name and the data
-    void add_column(const std::string& column_name, const ColumnType& new_col);
+    // (moved in when passed as an rvalue, instead of being copied)
+    void add_column(const std::string& column_name, ColumnType new_col);
+
+    // insert a column sharing a buffer, for instance one of get_data() of another dataframe;
+    // a buffer not created by a dataframe is copied by the first method changing the column
+    void add_column(const std::string& column_name, ColumnBuffer new_col);
+
+    // new dataframe made of some columns (by name, in the given order), sharing their buffers
+    DataFrame select(const std::vector<std::string>& names) const;
+
+    // rows of several dataframes one after the other: the columns are matched by
+    // name, in order of first appearance, and the rows of a dataframe without a
+    // column get nulls in it
+    static DataFrame concat(const std::vector<DataFrame>& frames);
 
     // set a custom header by passing as a vector of strings
     void set_header(const std::vector<std::string>& new_header);
@@ -55,12 +204,27 @@ public:
     // drop a column by name (string)
     void drop_col(const std::string& name);
 
+    // store a numeric column (by name) in a compressed encoding (see EncodedColumn):
+    // the statistics work on the encoded data and the methods changing the rows
+    // keep the encoding; get_column and get_data decode it on demand
+    void encode_column(const std::string& name, ColumnEncoding encoding = ColumnEncoding::Auto);
+
+    // store an encoded column (by name) as plain cells again
+    void decode_column(const std::string& name);
+
+    // return the encoding of a column (by name), nullopt if it is stored as plain cells
+    std::optional<ColumnEncoding> get_encoding(const std::string& name) const;
+
     // extract the column index for a given attribute name
     // if not present throw an error
     unsigned int find_idx(const std::string& name) const;
 
+    // resolve a column name once, see ColumnHandle
+    ColumnHandle get_handle(const std::string& name) const;
+
     // check if the data in the column (by name) are numeric
     bool is_numeric(const std::string& name) const;
+    bool is_numeric(ColumnHandle column) const;
 
     // print the number of nans for each attribute
     void table_nan() const;
@@ -68,9 +232,21 @@ public:
     // drop all the rows containing at least one nan
     void drop_row_nan();
 
+    // replace the nans of a numeric column (by name) with a constant value
+    void fillna(const std::string& name, double value);
+
+    // fill the nans (nulls and NaN values) of a numeric column (by name), which
+    // must not hold strings, by interpolating its valid values,
+    // using as abscissa the row number or, if given, the values of the column `by`
+    // (which must be finite and strictly increasing, the rows without abscissa
+    // being skipped); the nans before the first and after the last valid value
+    // are left as they are
+    void interpolate_missing(const std::string& name, FillMethod method = FillMethod::Linear, const std::string& by = "");
+
     // get a vector of double from a numeric column (passed by name)  
     // its needed for every gsl method
     std::vector<double> get_double_column(const std::string& name) const;
+    std::vector<double> get_double_column(ColumnHandle column) const;
 
     // get a vector of strings from a non numerical column (passed by name)
     std::vector<std::string> get_string_column(const std::string& name) const;
@@ -78,34 +254,87 @@ public:
     // usefull method to display the output in a formatted style
     unsigned int formatting_width() const;
 
+    // deep size in bytes of every column, in header order: the cells with the
+    // memory of their strings, or the buffers of an encoded column (a buffer
+    // shared with other dataframes is counted in each of them)
+    std::vector<std::size_t> memory_usage() const;
+
+    // export the dataframe through the Arrow C Data Interface, as a struct array
+    // (a record batch) with one child per column. Numeric columns become float64
+    // arrays: a column encoded as Plain shares its buffers without copying them,
+    // the other ones are converted once. Columns holding strings become utf8
+    // arrays (their numbers written as text). The caller owns the two structures
+    // and calls their release callbacks when done; the buffers stay valid even if
+    // the dataframe changes or is destroyed in the meantime
+    void export_arrow(ArrowArray* array, ArrowSchema* schema) const;
+
+    // replace the content with a struct array received through the Arrow C Data
+    // Interface, taking ownership of both structures (they are marked as released).
+    // float64 children become Plain encoded columns reading the Arrow buffers in
+    // place, kept alive until the last column using them is gone; integer, float32
+    // and utf8 children are converted to cells
+    void import_arrow(ArrowArray* array, ArrowSchema* schema);
+
     /* ---------------------------------------------------------------------- */
     /*                               STATISTICS                               */
     /* ---------------------------------------------------------------------- */
 
-    // statistics functions on numerical column (passed by name) 
+    // statistics functions on numerical column (passed by name or by handle) 
 
     double mean(const std::string& name) const;
+    double mean(ColumnHandle column) const;
 
     double median(const std::string& name) const;
+    double median(ColumnHandle column) const;
     
     double min(const std::string& name) const;
+    double min(ColumnHandle column) const;
     
     double max(const std::string& name) const;
+    double max(ColumnHandle column) const;
 
     // return the quantile of a column for a give value of probability
     double quantile(const std::string& name, const double& q) const;
+    double quantile(ColumnHandle column, const double& q) const;
     
     double var(const std::string& name) const;
+    double var(ColumnHandle column) const;
 
     double sd(const std::string& name) const;
+    double sd(ColumnHandle column) const;
     
+    // the pairwise statistics use the rows where both columns are valid,
+    // so a null in one column drops the row for the pair only
     double covariance(const std::string& name1, const std::string& name2) const;
 
     double correlation(const std::string& name1, const std::string& name2) const;
 
+    // number of rows where both columns are valid
+    std::size_t pairwise_count(const std::string& name1, const std::string& name2) const;
+
+    // covariance or correlation of every pair of numeric columns, with the
+    // number of rows used by each pair; every column is converted only once
+    PairwiseMatrix pairwise_covariance(const std::vector<std::string>& names) const;
+    PairwiseMatrix pairwise_correlation(const std::vector<std::string>& names) const;
+
     // print the correlation matrix for some attributes (passed as a vector of strings)
     void correlation_matrix(std::vector<std::string>& names) const;
 
+    // bootstrap distribution of a statistic: its value on each of n_resamples
+    // resamples (with replacement) of the valid rows of the columns, one column for
+    // Mean and Median, two for Correlation (using the rows valid in both; NaN
+    // values are not valid, they are dropped like the nulls). Every
+    // resample is drawn from its own counter-based random stream, so the result
+    // depends only on the seed and not on the number of threads
+    std::vector<double> bootstrap(Statistic stat, const std::vector<std::string>& columns, std::size_t n_resamples, std::uint64_t seed) const;
+
+    // sliding window statistics of a numeric column (see Rolling.hpp), with one
+    // value per row: the window of a row is made of the last
+    // `window` rows, or of the rows whose value of the increasing column `on` lies
+    // in (value - duration, value]
+    Rolling rolling(const std::string& name, std::size_t window, std::size_t min_periods = 1) const;
+    Rolling rolling(const std::string& name, double duration, const std::string& on, std::size_t min_periods = 1) const;
+
     // frequency table for the categorical data
     void table(const std::string& name) const;
 
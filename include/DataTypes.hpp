@@ -0,0 +1,20 @@
+#ifndef DATA_TYPES_HPP
+#define DATA_TYPES_HPP
+
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+// string cells use a polymorphic allocator so that the readers can place them
+// in the dataframe's string arena (short strings still fit in the SSO buffer)
+using StringType = std::pmr::string;
+using DataType = std::variant<double, StringType>;
+using ColumnType = std::vector<std::optional<DataType>>;
+
+// immutable cells of a column, shared by the dataframes copied from each other
+using ColumnBuffer = std::shared_ptr<const ColumnType>;
+
+#endif // DATA_TYPES_HPP
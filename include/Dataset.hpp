@@ -0,0 +1,63 @@
+#ifndef DATASET_HPP
+#define DATASET_HPP
+
+#include <cstddef>
+#include <functional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DataFrame.hpp"
+
+// A table split in many CSV and JSON files (by extension, .csv or .json, also
+// compressed as .csv.gz, .json.zst, ...), given as a directory, whose files are
+// searched recursively, or as a glob pattern (`*` and `?` within a path
+// component, `**` for any number of directories):
+//
+//     Dataset sales("exports/sales/**/*.csv");
+//     sales.filter("date", "2026-10-17");
+//     DataFrame day = sales.read();
+//
+// The directories named key=value (hive partitioning, e.g. date=2026-10-17/)
+// are partition keys: filter() drops the files of the partitions that are not
+// needed before anything is opened, and read() adds every key as a column.
+class Dataset {
+public:
+    explicit Dataset(const std::string& path, char separator = ',');
+
+    // the selected files, sorted by path
+    std::vector<std::string> files() const;
+
+    // the partition keys found in the paths, in order of appearance
+    std::vector<std::string> partition_keys() const;
+
+    // keep only the files whose partition `key` has a value accepted by `keep`
+    // (the files without that key are dropped as well)
+    Dataset& filter(const std::string& key, const std::function<bool(const std::string&)>& keep);
+    Dataset& filter(const std::string& key, const std::string& value);
+
+    // read all the selected files and concatenate them (see DataFrame::concat),
+    // in the order of files(). A loader thread reads the files ahead, keeping at
+    // most `prefetch` of them in memory, while the other threads parse them.
+    // A partition key whose values are numbers in all the selected files
+    // becomes a numeric column, any other one a string column
+    DataFrame read(std::size_t prefetch = 8) const;
+
+private:
+    enum class Format {Csv, Json};
+
+    struct File {
+        std::string path;
+        Format format;
+        std::vector<std::pair<std::string, std::string>> partitions;
+    };
+
+    std::vector<File> selected;
+    char separator;
+
+    // parse one file already loaded in memory and add its partition columns,
+    // as numbers for the keys in numeric_keys and as strings otherwise
+    DataFrame parse(const File& file, const std::string& content, const std::set<std::string>& numeric_keys) const;
+};
+
+#endif // DATASET_HPP
@@ -0,0 +1,92 @@
+#ifndef DECOMPRESSING_BUFFER_HPP
+#define DECOMPRESSING_BUFFER_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+// formats recognised by their first bytes
+enum class Compression {
+    None,
+    Gzip,       // gzip (also zlib) streams, with zlib
+    Zstd        // Zstandard frames, when the library is available
+};
+
+// Stream buffer reading the decompressed content of another stream. The
+// decompression runs on a separate thread, which fills a bounded queue of
+// blocks while the reader consumes them, so that parsing and decompression
+// overlap without ever holding the whole content in memory. An input that is
+// not compressed is passed through unchanged.
+class DecompressingBuffer : public std::streambuf {
+public:
+    // the source is read by the thread until the end, or until the buffer is
+    // destroyed; it must not be used in the meantime
+    explicit DecompressingBuffer(std::istream& source, std::size_t block_size = 1 << 18, std::size_t max_blocks = 4);
+
+    // stop the thread, also if the content was not read until the end
+    ~DecompressingBuffer() override;
+
+    DecompressingBuffer(const DecompressingBuffer&) = delete;
+    DecompressingBuffer& operator=(const DecompressingBuffer&) = delete;
+
+    // compression of data from its first bytes (four are enough)
+    static Compression detect(const char* bytes, std::size_t n);
+
+    // true if the format can be decompressed by this build
+    static bool available(Compression compression);
+
+protected:
+    // next block of the queue, waiting for the thread if needed;
+    // rethrow the error of the thread (e.g. corrupted data)
+    int_type underflow() override;
+
+private:
+    std::istream& source;
+    const std::size_t block_size;
+    const std::size_t max_blocks;
+
+    std::mutex mutex;
+    std::condition_variable filled, emptied;
+    std::deque<std::string> blocks;
+    std::string current;        // block being read
+    bool finished{false};       // the thread pushed its last block
+    bool stopping{false};       // the reader is gone
+    std::exception_ptr error;
+    std::thread worker;
+
+    void run();
+
+    // read up to size bytes of the source in chunk, return the number read
+    std::size_t read_source(std::string& chunk, std::size_t size);
+
+    // hand a block to the reader, false if the reader is gone
+    bool push(std::string& block);
+
+    // decompress the source, starting from the chunk already read
+    void pass_through(std::string& chunk);
+    void inflate_gzip(std::string& chunk);
+    void decompress_zstd(std::string& chunk);
+};
+
+// input stream over a DecompressingBuffer, which reports the errors of the
+// decompression as exceptions instead of a silent end of the data
+class DecompressingStream : public std::istream {
+public:
+    explicit DecompressingStream(std::istream& source);
+
+    // the stream to parse: `input` itself or, if it starts like a compressed
+    // format, a DecompressingStream over it stored in `holder`
+    static std::istream& wrap(std::istream& input, std::unique_ptr<DecompressingStream>& holder);
+
+private:
+    DecompressingBuffer buffer;
+};
+
+#endif // DECOMPRESSING_BUFFER_HPP
@@ -0,0 +1,90 @@
+#ifndef ENCODED_COLUMN_HPP
+#define ENCODED_COLUMN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "DataTypes.hpp"
+
+// compressed in-memory layouts for a numeric column
+enum class ColumnEncoding {
+    Plain,              // contiguous doubles and a validity bitmap
+    Constant,           // a single value repeated on every valid row
+    RunLength,          // runs of equal values (null runs included)
+    Delta,              // bit-packed differences between consecutive values
+    FrameOfReference,   // bit-packed offsets from the minimum value
+    Auto                // the smallest of the encodings applicable to the data
+};
+
+// An immutable numeric column stored with one of the encodings above.
+// Delta and FrameOfReference work on integers: they apply when every value,
+// multiplied by a power of ten (up to 1e9), is an exactly representable integer,
+// which is the case of values read from text with a fixed number of decimals.
+// Copies share the encoded buffers.
+class EncodedColumn {
+public:
+    EncodedColumn() = default;
+
+    // encode a numeric column, throw if it contains strings or if the
+    // requested encoding does not apply to its values
+    explicit EncodedColumn(const ColumnType& column, ColumnEncoding encoding = ColumnEncoding::Auto);
+
+    // Plain column reading `rows` doubles owned elsewhere, without copying them:
+    // `owner` is kept as long as the column (or a copy) exists. `validity` is the
+    // bitmap of the valid rows, empty if every row is valid
+    static EncodedColumn plain_view(const double* values, std::size_t rows, std::vector<std::uint64_t> validity, std::shared_ptr<const void> owner);
+
+    // encoding actually used (never Auto)
+    ColumnEncoding encoding() const;
+
+    // number of rows, nulls included
+    std::size_t size() const;
+
+    // number of valid (non null) rows
+    std::size_t count() const;
+
+    // value of a row, nullopt if the row is null
+    std::optional<double> at(std::size_t row) const;
+
+    // decode all the rows back to cells
+    ColumnType decode() const;
+
+    // decode the rows [begin, end) back to cells
+    ColumnType decode(std::size_t begin, std::size_t end) const;
+
+    // all the rows as cells, decoded on the first call (once, also if several
+    // threads ask at the same time) and then kept with the encoded buffers
+    const ColumnType& cells() const;
+
+    // decode only the valid values, in row order
+    std::vector<double> values() const;
+
+    // bytes used by the encoded buffers
+    std::size_t memory_usage() const;
+
+    // buffers that can be shared without copy: the values of a Plain column
+    // (nullptr for the other encodings) and the validity bitmap, one bit per row,
+    // least significant first (nullptr if every row is valid, or for RunLength);
+    // they stay valid as long as the pointer returned by buffers_owner()
+    const double* plain_values() const;
+    const std::uint64_t* validity_bitmap() const;
+    std::shared_ptr<const void> buffers_owner() const;
+
+    // statistics computed on the encoded blocks (sum and count of a run-length
+    // column, for example, only visit the runs); throw if there are no values
+    double sum() const;
+    double min() const;
+    double max() const;
+
+private:
+    struct Storage;
+    std::shared_ptr<const Storage> storage;
+
+    // call f(value) on the valid values, in row order
+    template <typename F>
+    void for_each_value(F&& f) const;
+};
+
+#endif // ENCODED_COLUMN_HPP
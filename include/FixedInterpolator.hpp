@@ -0,0 +1,147 @@
+#ifndef FIXED_INTERPOLATOR_HPP
+#define FIXED_INTERPOLATOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include "Interpolator.hpp"
+
+// Interpolators on a number of nodes N known at compile time, for the small
+// tables (a few to a few tens of nodes) evaluated in tight loops. The nodes
+// and the coefficients live in std::array members: no heap allocation, no
+// virtual call, and loops over the nodes unrolled by the compiler (the
+// searches and Horner's formula are folds over index sequences). The
+// constructors are constexpr, so that a table known at compile time is built
+// at compile time:
+//
+//     constexpr FixedLinear<4> table({0.0, 1.0, 2.0, 4.0}, {1.0, 3.0, 2.0, 0.0});
+//     static_assert(table(1.5) == 2.5);
+//
+// The nodes are checked like in Interpolator::set_data and the points like in
+// Interpolator::check_range (invalid nodes given at compile time do not compile).
+
+// Piecewise linear interpolation
+template <std::size_t N>
+class FixedLinear {
+    static_assert(N >= 2, "At least two nodes are required for interpolation.");
+
+public:
+    constexpr FixedLinear(const std::array<double, N>& x, const std::array<double, N>& y)
+        : x_nodes(x), y_nodes(y) {
+        Interpolator::validate_nodes(x.data(), N, N);
+        for (std::size_t i = 0; i + 1 < N; ++i) {
+            slopes[i] = (y[i + 1] - y[i]) / (x[i + 1] - x[i]);
+        }
+    }
+
+    constexpr double operator()(double x) const {
+        Interpolator::validate_point(x, x_nodes[0], x_nodes[N - 1]);
+        std::size_t i = interval(x, std::make_index_sequence<N - 2>{});
+        return y_nodes[i] + slopes[i] * (x - x_nodes[i]);
+    }
+
+private:
+    std::array<double, N> x_nodes{};
+    std::array<double, N> y_nodes{};
+    std::array<double, N - 1> slopes{};
+
+    // Number of inner nodes not greater than x: without any branch, and
+    // cheaper than a binary search for so few nodes
+    template <std::size_t... I>
+    constexpr std::size_t interval(double x, std::index_sequence<I...>) const {
+        static_cast<void>(x);   // unused for two nodes
+        return (std::size_t{0} + ... + static_cast<std::size_t>(x_nodes[I + 1] <= x));
+    }
+};
+
+// Polynomial interpolation with Newton's divided differences
+template <std::size_t N>
+class FixedNewton {
+    static_assert(N >= 2, "At least two nodes are required for interpolation.");
+
+public:
+    constexpr FixedNewton(const std::array<double, N>& x, const std::array<double, N>& y)
+        : x_nodes(x), coefficients(y) {
+        Interpolator::validate_nodes(x.data(), N, N);
+        for (std::size_t j = 1; j < N; ++j) {
+            for (std::size_t i = N - 1; i >= j; --i) {
+                coefficients[i] = (coefficients[i] - coefficients[i - 1]) / (x[i] - x[i - j]);
+            }
+        }
+    }
+
+    constexpr double operator()(double x) const {
+        Interpolator::validate_point(x, x_nodes[0], x_nodes[N - 1]);
+        return horner(x, std::make_index_sequence<N - 1>{});
+    }
+
+private:
+    std::array<double, N> x_nodes{};
+    std::array<double, N> coefficients{};
+
+    // result = result (x - x_i) + c_i for i = N-2 .. 0
+    template <std::size_t... I>
+    constexpr double horner(double x, std::index_sequence<I...>) const {
+        double result = coefficients[N - 1];
+        ((result = result * (x - x_nodes[N - 2 - I]) + coefficients[N - 2 - I]), ...);
+        return result;
+    }
+};
+
+// Natural cubic spline (zero second derivative at both ends)
+template <std::size_t N>
+class FixedSpline {
+    static_assert(N >= 2, "At least two nodes are required for interpolation.");
+
+public:
+    constexpr FixedSpline(const std::array<double, N>& x, const std::array<double, N>& y)
+        : x_nodes(x) {
+        Interpolator::validate_nodes(x.data(), N, N);
+        // Second derivatives m at the nodes, by the Thomas algorithm on
+        // h[i-1] m[i-1] + 2 (h[i-1] + h[i]) m[i] + h[i] m[i+1] = 6 (slope[i] - slope[i-1])
+        std::array<double, N - 1> h{}, slope{};
+        for (std::size_t i = 0; i + 1 < N; ++i) {
+            h[i] = x[i + 1] - x[i];
+            slope[i] = (y[i + 1] - y[i]) / h[i];
+        }
+        std::array<double, N> diagonal{}, m{};
+        for (std::size_t i = 1; i + 1 < N; ++i) {
+            diagonal[i] = 2.0 * (h[i - 1] + h[i]);
+            m[i] = 6.0 * (slope[i] - slope[i - 1]);
+            if (i > 1) {
+                double factor = h[i - 1] / diagonal[i - 1];
+                diagonal[i] -= factor * h[i - 1];
+                m[i] -= factor * m[i - 1];
+            }
+        }
+        for (std::size_t i = N - 1; i-- > 1;) {
+            m[i] = (m[i] - h[i] * m[i + 1]) / diagonal[i];
+        }
+        for (std::size_t i = 0; i + 1 < N; ++i) {
+            a[i] = y[i];
+            b[i] = slope[i] - h[i] * (2.0 * m[i] + m[i + 1]) / 6.0;
+            c[i] = m[i] / 2.0;
+            d[i] = (m[i + 1] - m[i]) / (6.0 * h[i]);
+        }
+    }
+
+    constexpr double operator()(double x) const {
+        Interpolator::validate_point(x, x_nodes[0], x_nodes[N - 1]);
+        std::size_t i = interval(x, std::make_index_sequence<N - 2>{});
+        double t = x - x_nodes[i];
+        return a[i] + t * (b[i] + t * (c[i] + t * d[i]));
+    }
+
+private:
+    std::array<double, N> x_nodes{};
+    // s(x) = a + t (b + t (c + t d)), t = x - x_i, on interval i
+    std::array<double, N - 1> a{}, b{}, c{}, d{};
+
+    template <std::size_t... I>
+    constexpr std::size_t interval(double x, std::index_sequence<I...>) const {
+        static_cast<void>(x);   // unused for two nodes
+        return (std::size_t{0} + ... + static_cast<std::size_t>(x_nodes[I + 1] <= x));
+    }
+};
+
+#endif // FIXED_INTERPOLATOR_HPP
@@ -0,0 +1,55 @@
+#ifndef GRID_INTERPOLATOR_HPP
+#define GRID_INTERPOLATOR_HPP
+
+#include <cstddef>
+#include <vector>
+#include "IntervalSearch.hpp"
+
+// Interpolation on a rectilinear grid of any dimension: the nodes of each
+// axis are strictly increasing (not necessarily equally spaced), and the
+// values are stored contiguously in row-major order, the last axis varying
+// fastest. For a 2-D table of values z(x, y):
+//
+//     GridInterpolator table({x, y}, z);      // z[i * y.size() + j] = z(x[i], y[j])
+//     double value = table({0.5, 1.2});
+//
+// The cell of a point is found axis by axis (O(1) on equally spaced axes,
+// O(log n) otherwise), then the values at the corners of the cell are
+// combined with the product of the weights of every axis.
+class GridInterpolator {
+public:
+    enum class Method {
+        Linear,     // bilinear, trilinear, ...: the 2^d corners of the cell
+        Cubic       // tensor product of cubic Hermite interpolations whose slopes are
+                    // finite differences (Catmull-Rom): C1, with 4^d values around the cell
+    };
+
+    GridInterpolator(const std::vector<std::vector<double>>& axes, const std::vector<double>& values,
+                     Method method = Method::Linear);
+
+    // value at a point given by its coordinates, one per axis
+    double operator()(const std::vector<double>& point) const;
+
+    // n points of dimension() coordinates each, one point after the other;
+    // every axis starts its search from the cell of the previous point, so
+    // consecutive points in the same cell, or in a close one, need no search
+    void evaluate(const double* points, double* out, std::size_t n) const;
+
+    // Same, returning the values
+    std::vector<double> evaluate(const std::vector<double>& points) const;
+
+    std::size_t dimension() const { return axes.size(); }
+
+private:
+    std::vector<std::vector<double>> axes;
+    std::vector<IntervalSearch> searches;
+    std::vector<std::size_t> strides;   // distance in values between neighbours along each axis
+    std::vector<double> values;
+    Method method;
+
+    // positions (already multiplied by the stride) and weights of the values
+    // used along an axis for the point x in interval i, `width` of each
+    void axis_weights(std::size_t axis, double x, std::size_t i, std::size_t* index, double* weight) const;
+};
+
+#endif // GRID_INTERPOLATOR_HPP
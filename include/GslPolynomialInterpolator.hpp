@@ -2,24 +2,68 @@
 #define GSL_POLYNOMIAL_INTERPOLATOR_HPP
 
 #include "Interpolator.hpp"
+#include <memory>
 #include <gsl/gsl_interp.h>
 #include <gsl/gsl_errno.h>
 
+// The const methods do not modify any state, so that an interpolator can be
+// evaluated from several threads at once
 class GslPolynomialInterpolator : public Interpolator {
 public:
+    // Search state of a GSL accelerator, for the callers written against the
+    // GSL interpolation types that use one. The polynomial type never reads
+    // it (its evaluation does not search an interval), so for this
+    // interpolator a cursor has no effect and is kept for API symmetry only.
+    // A cursor belongs to one caller: each thread uses its own
+    class Cursor {
+    public:
+        Cursor();
+
+        // forget the last interval found
+        void reset();
+
+    private:
+        friend class GslPolynomialInterpolator;
+
+        struct AccelDeleter {
+            void operator()(gsl_interp_accel* acc) const { gsl_interp_accel_free(acc); }
+        };
+        std::unique_ptr<gsl_interp_accel, AccelDeleter> acc;
+    };
+
     // Constructor that initialises the data
     GslPolynomialInterpolator(const std::vector<double>& x, const std::vector<double>& y);
 
+    // A copy builds its own GSL interpolator; a moved-from interpolator
+    // must not be evaluated any more
+    GslPolynomialInterpolator(const GslPolynomialInterpolator& other);
+    GslPolynomialInterpolator(GslPolynomialInterpolator&& other) noexcept = default;
+    GslPolynomialInterpolator& operator=(const GslPolynomialInterpolator& other);
+    GslPolynomialInterpolator& operator=(GslPolynomialInterpolator&& other) noexcept = default;
+
     // Destructor
-    ~GslPolynomialInterpolator();
+    ~GslPolynomialInterpolator() override = default;
 
-    // Operator overload for interpolation
+    // Operator overload for interpolation (no accelerator)
     double operator()(double x) const override;
 
+    // Same, passing the accelerator of the cursor to GSL (see Cursor)
+    double operator()(double x, Cursor& cursor) const;
+
+    // Evaluates the n points without accelerator
+    void evaluate(const double* xs, double* out, std::size_t n) const override;
+    using Interpolator::evaluate;
+
+    // The interpolating polynomial, expanded around the left node of each interval
+    PiecewisePolynomial to_piecewise() const override;
+
 private:
     void compute_coefficients();
-    gsl_interp* interp = nullptr;          // Pointer to gsl interpolator
-    gsl_interp_accel* acc = nullptr;       // Pointer to gsl accelerator
+
+    struct InterpDeleter {
+        void operator()(gsl_interp* interp) const { gsl_interp_free(interp); }
+    };
+    std::unique_ptr<gsl_interp, InterpDeleter> interp;     // gsl interpolator, read-only once initialised
 };
 
 #endif // GSL_POLYNOMIAL_INTERPOLATOR_HPP
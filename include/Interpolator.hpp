@@ -1,25 +1,87 @@
 #ifndef INTERPOLATOR_HPP
 #define INTERPOLATOR_HPP
 
+#include <cstddef>
+#include <stdexcept>
 #include <vector>
 
+class PiecewisePolynomial;
+
 class Interpolator {
 public:
+    Interpolator() = default;
     virtual ~Interpolator() = default;
 
+    // The nodes are copied or moved with the subclasses
+    Interpolator(const Interpolator&) = default;
+    Interpolator(Interpolator&&) noexcept = default;
+    Interpolator& operator=(const Interpolator&) = default;
+    Interpolator& operator=(Interpolator&&) noexcept = default;
+
     // Pure method for interpolating
     virtual double operator()(double x) const = 0;
 
+    // Evaluates the n points xs in one call and writes the results in out.
+    // The range of all the points is checked before any is evaluated; the
+    // subclasses override it with a loop without virtual calls, faster on
+    // sorted points. It may be called from several threads at once
+    virtual void evaluate(const double* xs, double* out, std::size_t n) const;
+
+    // Same, returning the values
+    std::vector<double> evaluate(const std::vector<double>& xs) const;
+
+    // Evaluates in parallel, each thread calling evaluate() on a contiguous
+    // chunk of at least min_chunk points (so a sorted input stays sorted)
+    void evaluate_parallel(const double* xs, double* out, std::size_t n, std::size_t min_chunk = 1 << 16) const;
+
+    // The same function as a piecewise polynomial, whose evaluation, derivative
+    // and integral are shared by all the methods (see PiecewisePolynomial.hpp)
+    virtual PiecewisePolynomial to_piecewise() const = 0;
+
     // Declaration for the data
     void set_data(const std::vector<double>& x, const std::vector<double>& y);
 
     // Method to check if a value x is within the range of the nodes
     void check_range(double x) const;
 
+    // Same for n values, with a single branch at the end
+    void check_range(const double* xs, std::size_t n) const;
+
+    // The checks of set_data on nx nodes x and ny values, constexpr so that
+    // the fixed-size interpolators (FixedInterpolator.hpp) share them, also
+    // at compile time, where invalid nodes do not compile
+    static constexpr void validate_nodes(const double* x, std::size_t nx, std::size_t ny) {
+        if (nx != ny || nx == 0) {
+            throw std::invalid_argument("Vectors x and y must have the same non-zero size.");
+        }
+        if (nx < 2) {
+            throw std::invalid_argument("At least two nodes are required for interpolation.");
+        }
+        // Check for duplicate x-values
+        for (std::size_t i = 1; i < nx; ++i) {
+            if (x[i] == x[i - 1]) {
+                throw std::invalid_argument("Duplicate x-values detected. x-values must be unique.");
+            }
+        }
+        // Ensure x-values are strictly increasing
+        for (std::size_t i = 1; i < nx; ++i) {
+            if (x[i] <= x[i - 1]) {
+                throw std::invalid_argument("x-values must be strictly increasing.");
+            }
+        }
+    }
+
+    // The check of check_range for the range [front, back]
+    static constexpr void validate_point(double x, double front, double back) {
+        // Written so that NaN is rejected as well
+        if (!(x >= front && x <= back)) {
+            throw std::out_of_range("x is outside the interpolation range.");
+        }
+    }
+
 protected:
     std::vector<double> x_nodes;
     std::vector<double> y_nodes;
 };
 
 #endif // INTERPOLATOR_HPP
-
@@ -0,0 +1,34 @@
+#ifndef INTERVAL_SEARCH_HPP
+#define INTERVAL_SEARCH_HPP
+
+#include <cstddef>
+#include <vector>
+
+// Finds the interval [x[i], x[i+1]) of strictly increasing nodes containing a
+// point, the last interval containing the last node as well. Equally spaced
+// nodes (up to rounding) are detected once, their interval being then found
+// by a division; other nodes use a branchless binary search. The nodes are
+// not stored: they are passed to every search and must be the ones given to
+// the constructor.
+class IntervalSearch {
+public:
+    IntervalSearch() = default;
+    explicit IntervalSearch(const std::vector<double>& x);
+
+    // O(1) for equally spaced nodes, O(log n) otherwise; x must be within the range
+    std::size_t find(const std::vector<double>& x, double point) const;
+
+    // Same, starting from the interval `hint` of the previous point: a point
+    // at most a few intervals after it needs no search, so that sorted points
+    // cost O(1) each
+    std::size_t find_from(const std::vector<double>& x, double point, std::size_t hint) const;
+
+    // true if the nodes are equally spaced
+    bool uniform() const { return uniform_spacing; }
+
+private:
+    bool uniform_spacing{false};
+    double inverse_step{0.0};       // 1 / step, for equally spaced nodes
+};
+
+#endif // INTERVAL_SEARCH_HPP
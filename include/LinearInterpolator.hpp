@@ -2,14 +2,34 @@
 #define LINEAR_INTERPOLATOR_HPP
 
 #include "Interpolator.hpp"
+#include "IntervalSearch.hpp"
+#include <cstddef>
 #include <stdexcept>
 
 class LinearInterpolator : public Interpolator {
 public:
+    // The slopes of the intervals are computed once here, and the nodes are
+    // checked for equal spacing (up to rounding)
     LinearInterpolator(const std::vector<double>& x, const std::vector<double>& y);
     
+    // O(1) for equally spaced nodes, O(log n) otherwise
     double operator()(double x) const override;
+
+    // Evaluates the n points xs in one call and writes the results in out:
+    // a query at most a few intervals after the previous one needs no search,
+    // so sorted queries cost O(n) plus a search per longer jump
+    void evaluate(const double* xs, double* out, std::size_t n) const override;
+    using Interpolator::evaluate;
+
+    // Degree 1: the values and the slopes of the intervals
+    PiecewisePolynomial to_piecewise() const override;
+
+    // true if the nodes are equally spaced, the intervals being then found by a division
+    bool uniform() const { return search.uniform(); }
+
+private:
+    std::vector<double> slopes;     // slopes[i]: slope on [x_nodes[i], x_nodes[i+1]]
+    IntervalSearch search;
 };
 
 #endif // LINEAR_INTERPOLATOR_HPP
-
@@ -0,0 +1,47 @@
+#ifndef MULTI_OUTPUT_INTERPOLATOR_HPP
+#define MULTI_OUTPUT_INTERPOLATOR_HPP
+
+#include <cstddef>
+#include <vector>
+#include "IntervalSearch.hpp"
+
+// Linear interpolation of m series sharing the same n nodes, e.g. many
+// columns against one time column. The values are stored as an n x m matrix
+// in row-major order (the m values of a node next to each other), with the
+// slopes of the intervals in the same layout: a point costs one interval
+// search, then one multiply-add per series over contiguous memory, a loop the
+// compiler vectorises.
+class MultiOutputInterpolator {
+public:
+    // series[j][i]: value of series j at node x[i]
+    MultiOutputInterpolator(const std::vector<double>& x, const std::vector<std::vector<double>>& series);
+
+    // values[i * outputs + j]: value of series j at node x[i]
+    MultiOutputInterpolator(const std::vector<double>& x, const std::vector<double>& values, std::size_t outputs);
+
+    // the outputs() values at x, written in out
+    void operator()(double x, double* out) const;
+
+    // Same, returning the values
+    std::vector<double> operator()(double x) const;
+
+    // n points, out receiving n x outputs() values in row-major order; the
+    // search starts from the interval of the previous point
+    void evaluate(const double* xs, double* out, std::size_t n) const;
+
+    std::size_t outputs() const { return m; }
+
+private:
+    std::vector<double> x_nodes;
+    std::size_t m{0};
+    std::vector<double> values;     // values[i * m + j]
+    std::vector<double> slopes;     // slopes[i * m + j], on [x_i, x_{i+1}]
+    IntervalSearch search;
+
+    void compute_slopes();
+
+    // the m outputs at x in interval i
+    void interpolate(std::size_t i, double x, double* out) const;
+};
+
+#endif // MULTI_OUTPUT_INTERPOLATOR_HPP
@@ -11,12 +11,28 @@ public:
     // Operator overload to perform interpolation on the value ‘x’
     double operator()(double x) const override;
 
+    // Horner's formula on blocks of points, the inner loop running over the
+    // points of the block so that it is vectorised
+    void evaluate(const double* xs, double* out, std::size_t n) const override;
+    using Interpolator::evaluate;
+
+    // The interpolating polynomial, expanded around the left node of each interval
+    PiecewisePolynomial to_piecewise() const override;
+
+    // Adds the node (x, y), extending the divided-difference table in O(n);
+    // x may lie outside the current range, which grows accordingly
+    void add_node(double x, double y);
+
 private:
     // Method for calculating Newton's coefficients
     void compute_coefficients();
 
+    // Appends a node to the Newton form: one new row of the divided-difference table
+    void extend_table(double x, double y);
+
     std::vector<double> coefficients; // Stores Newton's coefficients
-    
+    std::vector<double> newton_nodes; // Nodes in the order of insertion, those of the Newton form
+    std::vector<double> diagonal;     // Last row of the table: diagonal[k] = f[x_{n-1-k}, ..., x_{n-1}]
 };
 
 #endif // NEWTON_INTERPOLATOR_HPP 
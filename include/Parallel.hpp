@@ -0,0 +1,67 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+// number of worker threads to use (at least one)
+inline unsigned int thread_count()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// split [0, n) in contiguous chunks of at least min_chunk elements and call
+// f(begin, end) on each of them from a different thread; the first exception
+// thrown by a worker is rethrown in the calling thread
+template <typename F>
+void for_chunks(std::size_t n, std::size_t min_chunk, F&& f)
+{
+    std::size_t n_chunks = std::min<std::size_t>(thread_count(), (n + min_chunk - 1) / std::max<std::size_t>(min_chunk, 1));
+    if (n_chunks <= 1) {
+        f(std::size_t{0}, n);
+        return;
+    }
+
+    // chunk k is [k * n / n_chunks, (k + 1) * n / n_chunks): as n_chunks <= n,
+    // none is empty and none starts past n
+    auto bound = [n, n_chunks](std::size_t k) { return k * n / n_chunks; };
+    std::vector<std::exception_ptr> errors(n_chunks);
+    std::vector<std::thread> workers;
+    workers.reserve(n_chunks - 1);
+
+    // the calling thread takes the first chunk
+    for (std::size_t k = 1; k < n_chunks; ++k) {
+        std::size_t begin = bound(k);
+        std::size_t end = bound(k + 1);
+        workers.emplace_back([&f, &errors, k, begin, end]() {
+            try {
+                f(begin, end);
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        });
+    }
+    try {
+        f(std::size_t{0}, bound(1));
+    } catch (...) {
+        errors[0] = std::current_exception();
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+} // namespace parallel
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,59 @@
+#ifndef PIECEWISE_POLYNOMIAL_HPP
+#define PIECEWISE_POLYNOMIAL_HPP
+
+#include "Interpolator.hpp"
+#include "IntervalSearch.hpp"
+#include <cstddef>
+
+// Polynomial of a given degree on each interval between breakpoints,
+//
+//     p(x) = sum_k c[k][i] (x - x_i)^k     on [x_i, x_{i+1}]
+//
+// the representation every interpolator compiles to (see to_piecewise()), so
+// that any method can be evaluated, differentiated and integrated by the same
+// code. The coefficients of a power are stored contiguously for all the
+// intervals (structure of arrays).
+class PiecewisePolynomial : public Interpolator {
+public:
+    // coefficients[k][i]: coefficient of (x - x_i)^k on interval i, for
+    // k = 0..degree; every coefficients[k] has breakpoints.size() - 1 values
+    PiecewisePolynomial(const std::vector<double>& breakpoints, const std::vector<std::vector<double>>& coefficients);
+
+    // The polynomial of degree n - 1 through the n nodes, expanded around the
+    // left node of each interval: O(n^2) memory and O(n^3) time, meant for the
+    // low degrees the global polynomial methods are used with
+    static PiecewisePolynomial interpolating_polynomial(const std::vector<double>& x, const std::vector<double>& y);
+
+    double operator()(double x) const override;
+
+    // Walks the intervals forward on sorted points and applies Horner's
+    // formula, unrolled for the cubics
+    void evaluate(const double* xs, double* out, std::size_t n) const override;
+    using Interpolator::evaluate;
+
+    PiecewisePolynomial to_piecewise() const override;
+
+    // Derivative of the given order, a piecewise polynomial of lower degree
+    // (the constant zero beyond the degree)
+    PiecewisePolynomial derivative(std::size_t order = 1) const;
+
+    // Integral from a to b, both within the range (negative if b < a)
+    double integral(double a, double b) const;
+
+    std::size_t degree() const { return terms - 1; }
+
+    // coefficient of (x - x_i)^power on interval i
+    double coefficient(std::size_t power, std::size_t interval) const { return coefficients[power * pieces + interval]; }
+
+private:
+    std::size_t pieces{0};              // number of intervals
+    std::size_t terms{0};               // degree + 1
+    std::vector<double> coefficients;   // coefficients[k * pieces + i]
+    std::vector<double> cumulative;     // cumulative[i]: integral from x_0 to x_i
+    IntervalSearch search;
+
+    // integral of interval i from x_i to x_i + t
+    double partial_integral(std::size_t i, double t) const;
+};
+
+#endif // PIECEWISE_POLYNOMIAL_HPP
@@ -0,0 +1,87 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Timing of the operations of the DataFrame and Interpolation libraries.
+// An operation is timed by a SCI_PROFILE_SCOPE("name") at the top of its body,
+// and SCI_PROFILE_COUNT("counter", value) adds a quantity (rows, bytes, ...) to
+// the innermost operation running on the calling thread.
+//
+// The instrumentation is compiled in by default (CMake option PROFILING) and
+// stays off until enable(true): a disabled scope only reads a flag. With
+// -DPROFILING=OFF the macros expand to nothing and available() is false.
+class Profiler {
+public:
+    // time and counters of an operation, summed over all its calls
+    struct Stats {
+        std::size_t calls{0};
+        double total_ms{0.0};
+        double max_ms{0.0};
+        std::map<std::string, double> counters;
+    };
+
+    // true if the libraries were built with the instrumentation
+    static bool available();
+
+    // switch the recording on or off at run time
+    static void enable(bool on);
+
+    static bool enabled();
+
+    // forget the recorded operations
+    static void reset();
+
+    // statistics of every operation recorded so far
+    static std::map<std::string, Stats> report();
+
+    // print the report as a table
+    static void print(std::ostream& out = std::cout);
+
+    // write the report as a JSON object keyed by operation
+    static void write_json(const std::string& filename);
+
+    // write every recorded call in the Chrome trace event format, which can be
+    // opened in chrome://tracing or https://ui.perfetto.dev
+    static void write_chrome_trace(const std::string& filename);
+
+    // add a counter to the innermost scope open on this thread, if any
+    static void count(const char* counter, double value);
+
+    // times the enclosing block under the name of an operation
+    class Scope {
+    public:
+        explicit Scope(const char* operation);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        void count(const char* counter, double value);
+
+    private:
+        const char* operation;
+        bool active;
+        Scope* parent{nullptr};
+        std::chrono::steady_clock::time_point start;
+        std::vector<std::pair<const char*, double>> counters;
+    };
+};
+
+#ifdef SCI_PROFILING
+#define SCI_PROFILE_CONCAT_IMPL(a, b) a##b
+#define SCI_PROFILE_CONCAT(a, b) SCI_PROFILE_CONCAT_IMPL(a, b)
+#define SCI_PROFILE_SCOPE(operation) Profiler::Scope SCI_PROFILE_CONCAT(profile_scope_, __LINE__)(operation)
+#define SCI_PROFILE_COUNT(counter, value) Profiler::count(counter, value)
+#else
+#define SCI_PROFILE_SCOPE(operation) static_cast<void>(0)
+#define SCI_PROFILE_COUNT(counter, value) static_cast<void>(sizeof(value))
+#endif
+
+#endif // PROFILER_HPP
@@ -0,0 +1,57 @@
+#ifndef ROLLING_HPP
+#define ROLLING_HPP
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+// Statistics over a window sliding along a numeric column. The window of a row
+// ends at that row and is either the last `window` rows or, for a time-based
+// window, the rows whose time lies in (time - duration, time]. The nulls (and
+// NaN values, taken as nulls) inside a window are skipped; a row whose window holds fewer than `min_periods` valid
+// values (two for var and sd) gets a null. The results are plain optional
+// doubles, much smaller than the cells of a DataFrame.
+//
+// Every statistic is computed in one pass, in O(n) for the moments, min and max
+// and O(n log w) for the quantiles, w being the number of values in a window.
+class Rolling {
+public:
+    // window of a fixed number of rows (at least one)
+    Rolling(std::vector<std::optional<double>> values, std::size_t window, std::size_t min_periods = 1);
+
+    // window of a fixed duration on an increasing, finite time column, with one time per value
+    Rolling(std::vector<std::optional<double>> values, const std::vector<double>& times, double duration, std::size_t min_periods = 1);
+
+    std::vector<std::optional<double>> sum() const;
+    std::vector<std::optional<double>> mean() const;
+    std::vector<std::optional<double>> var() const;     // sample variance, as var() of the DataFrame
+    std::vector<std::optional<double>> sd() const;
+    std::vector<std::optional<double>> min() const;
+    std::vector<std::optional<double>> max() const;
+
+    // quantile interpolated between the closest ranks, as quantile() of the DataFrame
+    std::vector<std::optional<double>> quantile(double q) const;
+
+private:
+    std::vector<std::optional<double>> values;
+    std::vector<std::size_t> starts;    // first row of the window of every row
+    std::size_t min_periods;
+
+    // turn the NaN values into nulls
+    void drop_nan();
+
+    // call add(value) and remove(value) to move the window forward, then
+    // result(count) to get the statistic of the valid values in the window
+    template <typename Add, typename Remove, typename Result>
+    std::vector<std::optional<double>> slide(Add add, Remove remove, Result result, std::size_t required) const;
+
+    // running mean and sum of squared deviations (Welford), mapped by f(count, mean, m2)
+    template <typename F>
+    std::vector<std::optional<double>> moments(F f, std::size_t required) const;
+
+    // min (less) or max (greater) with a monotonic deque of row indices
+    template <typename Compare>
+    std::vector<std::optional<double>> extremum(Compare compare) const;
+};
+
+#endif // ROLLING_HPP
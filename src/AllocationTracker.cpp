@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "AllocationTracker.hpp"
+// the size of a block is asked to the allocator, which only some C libraries allow
+#ifdef SCI_TRACK_ALLOCATIONS
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__GLIBC__) || defined(_WIN32)
+#include <malloc.h>
+#else
+#error "TRACK_ALLOCATIONS needs malloc_usable_size (glibc), malloc_size (Apple) or _msize (Windows)"
+#endif
+#endif
+
+namespace {
+
+std::atomic<bool> tracking{false};
+// signed: memory allocated before enable() may be freed while counting
+std::atomic<std::int64_t> live{0};
+
+// counts of the allocations made by the calling thread, read by the scopes:
+// the scopes open on concurrent threads do not see each other's work
+thread_local std::size_t thread_allocations{0};
+thread_local std::size_t thread_bytes{0};
+// signed: a thread may free memory allocated by another one
+thread_local std::int64_t thread_live{0};
+thread_local std::int64_t thread_peak{0};
+
+// set while the tracker updates its own report, whose allocations are not counted
+thread_local bool inside_tracker{false};
+
+std::mutex report_mutex;
+
+std::map<std::string, AllocationTracker::Stats>& report_map()
+{
+    static std::map<std::string, AllocationTracker::Stats> stats;
+    return stats;
+}
+
+#ifdef SCI_TRACK_ALLOCATIONS
+
+// usable size of a block returned by malloc
+std::size_t block_size(void* p)
+{
+#if defined(__APPLE__)
+    return malloc_size(p);
+#elif defined(_WIN32)
+    return _msize(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+void record_allocation(void* p)
+{
+    if (p == nullptr || !tracking.load(std::memory_order_relaxed) || inside_tracker) {
+        return;
+    }
+    std::size_t size = block_size(p);
+    live.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    ++thread_allocations;
+    thread_bytes += size;
+    thread_live += static_cast<std::int64_t>(size);
+    thread_peak = std::max(thread_peak, thread_live);
+}
+
+void record_deallocation(void* p)
+{
+    if (p == nullptr || !tracking.load(std::memory_order_relaxed) || inside_tracker) {
+        return;
+    }
+    std::size_t size = block_size(p);
+    live.fetch_sub(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    thread_live -= static_cast<std::int64_t>(size);
+}
+
+void* allocate(std::size_t size)
+{
+    void* p = std::malloc(size == 0 ? 1 : size);
+    record_allocation(p);
+    return p;
+}
+
+void deallocate(void* p)
+{
+    record_deallocation(p);
+    std::free(p);
+}
+
+#endif
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                  REPLACEMENT OF THE GLOBAL OPERATOR NEW                    */
+/* -------------------------------------------------------------------------- */
+
+#ifdef SCI_TRACK_ALLOCATIONS
+
+void* operator new(std::size_t size)
+{
+    // as the standard operator new: call the new handler, which may free
+    // some memory, until the allocation succeeds or there is no handler
+    while (true) {
+        void* p = allocate(size);
+        if (p != nullptr) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    // the new handler is called as well, and may throw
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept
+{
+    deallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    deallocate(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    deallocate(p);
+}
+
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                                  TRACKER                                   */
+/* -------------------------------------------------------------------------- */
+
+bool AllocationTracker::available()
+{
+#ifdef SCI_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+void AllocationTracker::enable(bool on)
+{
+    tracking.store(on && available());
+}
+
+bool AllocationTracker::enabled()
+{
+    return tracking.load(std::memory_order_relaxed);
+}
+
+std::int64_t AllocationTracker::live_bytes()
+{
+    return live.load();
+}
+
+std::map<std::string, AllocationTracker::Stats> AllocationTracker::report()
+{
+    inside_tracker = true;
+    std::map<std::string, Stats> copy;
+    {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        copy = report_map();
+    }
+    inside_tracker = false;
+    return copy;
+}
+
+void AllocationTracker::reset()
+{
+    std::lock_guard<std::mutex> lock(report_mutex);
+    report_map().clear();
+}
+
+void AllocationTracker::print(std::ostream& out)
+{
+    auto stats = report();
+    out << std::left << std::setw(24) << "Operation"
+        << std::setw(10) << "Calls"
+        << std::setw(16) << "Allocations"
+        << std::setw(16) << "Bytes"
+        << std::setw(16) << "Peak bytes" << "\n";
+    out << std::string(82, '-') << "\n";
+    for (const auto& [operation, s] : stats) {
+        out << std::left << std::setw(24) << operation
+            << std::setw(10) << s.calls
+            << std::setw(16) << s.allocations
+            << std::setw(16) << s.bytes
+            << std::setw(16) << s.peak_bytes << "\n";
+    }
+}
+
+AllocationTracker::Scope::Scope(const char* operation)
+    : operation(operation), active(enabled())
+{
+    if (!active) {
+        return;
+    }
+    start_allocations = thread_allocations;
+    start_bytes = thread_bytes;
+    start_live = thread_live;
+    // measure the peak of this scope from the current level
+    saved_peak = std::exchange(thread_peak, start_live);
+}
+
+AllocationTracker::Scope::~Scope()
+{
+    if (!active) {
+        return;
+    }
+    std::size_t n = thread_allocations - start_allocations;
+    std::size_t bytes = thread_bytes - start_bytes;
+    std::int64_t scope_peak = thread_peak;
+    // an enclosing scope must still see the highest level reached
+    thread_peak = std::max(saved_peak, scope_peak);
+
+    inside_tracker = true;
+    {
+        std::lock_guard<std::mutex> lock(report_mutex);
+        Stats& s = report_map()[operation];
+        s.calls += 1;
+        s.allocations += n;
+        s.bytes += bytes;
+        s.peak_bytes = std::max(s.peak_bytes, static_cast<std::size_t>(std::max<std::int64_t>(0, scope_peak - start_live)));
+    }
+    inside_tracker = false;
+}
@@ -0,0 +1,148 @@
+#include "BarycentricInterpolator.hpp"
+#include "PiecewisePolynomial.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+BarycentricInterpolator::BarycentricInterpolator(const std::vector<double>& x, const std::vector<double>& y) {
+    set_data(x, y);
+    scale = (x_nodes.back() - x_nodes.front()) / 4.0;
+    compute_weights();
+}
+
+BarycentricInterpolator::BarycentricInterpolator(std::vector<double> x, std::vector<double> y,
+                                                 std::vector<double> w, double scale)
+    : weights(std::move(w)), scale(scale) {
+    x_nodes = std::move(x);
+    y_nodes = std::move(y);
+}
+
+// w_j = 1 / prod_{k != j} (x_j - x_k), with the differences scaled
+void BarycentricInterpolator::compute_weights() {
+    SCI_PROFILE_SCOPE("BarycentricInterpolator::compute_weights");
+    const std::size_t n = x_nodes.size();
+    weights.assign(n, 1.0);
+    for (std::size_t j = 0; j < n; ++j) {
+        for (std::size_t k = 0; k < n; ++k) {
+            if (k != j) {
+                weights[j] *= (x_nodes[j] - x_nodes[k]) / scale;
+            }
+        }
+    }
+    for (double& w : weights) {
+        w = 1.0 / w;
+    }
+}
+
+std::vector<double> BarycentricInterpolator::chebyshev_nodes(double a, double b, std::size_t n) {
+    if (n < 2 || !(a < b)) {
+        throw std::invalid_argument("At least two nodes and a < b are required for Chebyshev nodes.");
+    }
+    const double pi = std::acos(-1.0);
+    const double center = 0.5 * (a + b);
+    const double radius = 0.5 * (b - a);
+    std::vector<double> x(n);
+    for (std::size_t j = 0; j < n; ++j) {
+        // sin(pi/2 * (2j - n + 1) / (n - 1)) = -cos(pi j / (n - 1)), symmetric to rounding
+        double angle = 0.5 * pi * (2.0 * static_cast<double>(j) - static_cast<double>(n - 1)) / static_cast<double>(n - 1);
+        x[j] = center + radius * std::sin(angle);
+    }
+    x.front() = a;
+    x.back() = b;
+    return x;
+}
+
+BarycentricInterpolator BarycentricInterpolator::chebyshev(double a, double b, const std::vector<double>& y) {
+    SCI_PROFILE_SCOPE("BarycentricInterpolator::chebyshev");
+    std::vector<double> x = chebyshev_nodes(a, b, y.size());
+    // w_j = (-1)^(n-1-j) delta_j / (2 (n - 1)), delta_j = 1/2 at the ends and 1
+    // elsewhere: the weights of the product formula with differences scaled by (b - a) / 4
+    const std::size_t n = x.size();
+    std::vector<double> w(n);
+    const double magnitude = 1.0 / (2.0 * static_cast<double>(n - 1));
+    for (std::size_t j = 0; j < n; ++j) {
+        double delta = (j == 0 || j == n - 1) ? 0.5 : 1.0;
+        w[j] = ((n - 1 - j) % 2 == 0 ? 1.0 : -1.0) * delta * magnitude;
+    }
+    return BarycentricInterpolator(std::move(x), y, std::move(w), (b - a) / 4.0);
+}
+
+BarycentricInterpolator BarycentricInterpolator::chebyshev(double a, double b, std::size_t n,
+                                                           const std::function<double(double)>& f) {
+    std::vector<double> y;
+    y.reserve(n);
+    for (double x : chebyshev_nodes(a, b, n)) {
+        y.push_back(f(x));
+    }
+    return chebyshev(a, b, y);
+}
+
+double BarycentricInterpolator::barycentric_sum(double x) const {
+    const std::size_t n = x_nodes.size();
+    double numerator = 0.0;
+    double denominator = 0.0;
+    for (std::size_t j = 0; j < n; ++j) {
+        double t = weights[j] / (x - x_nodes[j]);
+        numerator += t * y_nodes[j];
+        denominator += t;
+    }
+    return numerator / denominator;
+}
+
+double BarycentricInterpolator::operator()(double x) const {
+    check_range(x);
+    // At a node the formula divides by zero: the value is returned as is
+    auto it = std::lower_bound(x_nodes.begin(), x_nodes.end(), x);
+    if (*it == x) {
+        return y_nodes[static_cast<std::size_t>(it - x_nodes.begin())];
+    }
+    return barycentric_sum(x);
+}
+
+void BarycentricInterpolator::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("BarycentricInterpolator::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    check_range(xs, n);
+    // The nodes are searched only for the points where the sum is not finite
+    for (std::size_t k = 0; k < n; ++k) {
+        out[k] = barycentric_sum(xs[k]);
+        if (!std::isfinite(out[k])) {
+            auto it = std::lower_bound(x_nodes.begin(), x_nodes.end(), xs[k]);
+            if (*it == xs[k]) {
+                out[k] = y_nodes[static_cast<std::size_t>(it - x_nodes.begin())];
+            }
+        }
+    }
+}
+
+void BarycentricInterpolator::add_node(double x, double y) {
+    SCI_PROFILE_SCOPE("BarycentricInterpolator::add_node");
+    if (!std::isfinite(x)) {
+        throw std::invalid_argument("x-values must be finite.");
+    }
+    auto it = std::lower_bound(x_nodes.begin(), x_nodes.end(), x);
+    if (it != x_nodes.end() && *it == x) {
+        throw std::invalid_argument("Duplicate x-values detected. x-values must be unique.");
+    }
+
+    // w_j / (x_j - x) for the existing nodes, 1 / prod_j (x - x_j) for the new one
+    double w_new = 1.0;
+    for (std::size_t j = 0; j < x_nodes.size(); ++j) {
+        double difference = (x_nodes[j] - x) / scale;
+        weights[j] /= difference;
+        w_new *= -difference;
+    }
+
+    // The nodes stay sorted, for check_range and the search of exact nodes
+    std::size_t position = static_cast<std::size_t>(it - x_nodes.begin());
+    x_nodes.insert(x_nodes.begin() + position, x);
+    y_nodes.insert(y_nodes.begin() + position, y);
+    weights.insert(weights.begin() + position, 1.0 / w_new);
+    SCI_PROFILE_COUNT("nodes", x_nodes.size());
+}
+
+PiecewisePolynomial BarycentricInterpolator::to_piecewise() const {
+    return PiecewisePolynomial::interpolating_polynomial(x_nodes, y_nodes);
+}
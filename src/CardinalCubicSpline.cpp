@@ -1,4 +1,6 @@
 #include "CardinalCubicSpline.hpp"
+#include "PiecewisePolynomial.hpp"
+#include "Profiler.hpp"
 
 // Constructor initialising the cubic spline of Boost
 CardinalCubicSpline::CardinalCubicSpline(const std::vector<double>& x, const std::vector<double>& y, double start, double step)
@@ -15,6 +17,33 @@ double CardinalCubicSpline::operator()(double x) const {
     return spline(x);
 }
 
+void CardinalCubicSpline::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("CardinalCubicSpline::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    check_range(xs, n);
+    for (std::size_t k = 0; k < n; ++k) {
+        out[k] = spline(xs[k]);
+    }
+}
+
+// The knots of the B-spline are the nodes: the spline is a cubic on each
+// interval, given by its value, slope and curvature at the left node (the
+// curvature being continuous, the cubic term follows from the right node)
+PiecewisePolynomial CardinalCubicSpline::to_piecewise() const {
+    const std::size_t pieces = x_nodes.size() - 1;
+    std::vector<std::vector<double>> coefficients(4, std::vector<double>(pieces));
+    double curvature = spline.double_prime(x_nodes[0]);
+    for (std::size_t i = 0; i < pieces; ++i) {
+        double next_curvature = spline.double_prime(x_nodes[i + 1]);
+        coefficients[0][i] = spline(x_nodes[i]);
+        coefficients[1][i] = spline.prime(x_nodes[i]);
+        coefficients[2][i] = curvature / 2.0;
+        coefficients[3][i] = (next_curvature - curvature) / (6.0 * (x_nodes[i + 1] - x_nodes[i]));
+        curvature = next_curvature;
+    }
+    return PiecewisePolynomial(x_nodes, coefficients);
+}
+
 // Method to check if the steps between nodes are equal
 void CardinalCubicSpline::check_steps(const std::vector<double>& x) const {
     double step = x[1] - x[0]; // Expected step between nodes
@@ -0,0 +1,135 @@
+#include "CubicSpline.hpp"
+#include "PiecewisePolynomial.hpp"
+#include "Profiler.hpp"
+#include <stdexcept>
+
+namespace {
+
+// Thomas algorithm for the tridiagonal system with sub-diagonal `lower`,
+// diagonal `diagonal` and super-diagonal `upper` (lower[0] and upper[n-1] are
+// not used); the solution replaces rhs
+void solve_tridiagonal(const std::vector<double>& lower, std::vector<double>& diagonal,
+                       const std::vector<double>& upper, std::vector<double>& rhs) {
+    const std::size_t n = diagonal.size();
+    for (std::size_t i = 1; i < n; ++i) {
+        double factor = lower[i] / diagonal[i - 1];
+        diagonal[i] -= factor * upper[i - 1];
+        rhs[i] -= factor * rhs[i - 1];
+    }
+    rhs[n - 1] /= diagonal[n - 1];
+    for (std::size_t i = n - 1; i-- > 0;) {
+        rhs[i] = (rhs[i] - upper[i] * rhs[i + 1]) / diagonal[i];
+    }
+}
+
+} // namespace
+
+CubicSpline::CubicSpline(const std::vector<double>& x, const std::vector<double>& y,
+                         Boundary boundary, double left_slope, double right_slope) {
+    set_data(x, y);
+    compute_coefficients(boundary, left_slope, right_slope);
+    search = IntervalSearch(x_nodes);
+}
+
+void CubicSpline::compute_coefficients(Boundary boundary, double left_slope, double right_slope) {
+    SCI_PROFILE_SCOPE("CubicSpline::compute_coefficients");
+    const std::size_t n = x_nodes.size();
+    std::vector<double> h(n - 1), slope(n - 1);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        h[i] = x_nodes[i + 1] - x_nodes[i];
+        slope[i] = (y_nodes[i + 1] - y_nodes[i]) / h[i];
+    }
+
+    // Second derivatives m at the nodes. Inside:
+    // h[i-1] m[i-1] + 2 (h[i-1] + h[i]) m[i] + h[i] m[i+1] = 6 (slope[i] - slope[i-1])
+    std::vector<double> m(n, 0.0);
+    if (boundary == Boundary::NotAKnot && n <= 3) {
+        // a single parabola (a line for two nodes) through the nodes
+        double second = n == 3 ? 2.0 * (slope[1] - slope[0]) / (h[0] + h[1]) : 0.0;
+        m.assign(n, second);
+    } else if (boundary == Boundary::NotAKnot) {
+        // m[0] and m[n-1] are eliminated from the first and last equations:
+        // m[0] = m[1] + h[0] / h[1] (m[1] - m[2]), and the same at the other end
+        const std::size_t k = n - 2;    // unknowns m[1..n-2]
+        std::vector<double> lower(k), diagonal(k), upper(k), rhs(k);
+        for (std::size_t r = 0; r < k; ++r) {
+            std::size_t i = r + 1;
+            lower[r] = h[i - 1];
+            diagonal[r] = 2.0 * (h[i - 1] + h[i]);
+            upper[r] = h[i];
+            rhs[r] = 6.0 * (slope[i] - slope[i - 1]);
+        }
+        diagonal[0] = (h[0] + h[1]) * (h[0] + 2.0 * h[1]) / h[1];
+        upper[0] = (h[1] - h[0]) * (h[1] + h[0]) / h[1];
+        diagonal[k - 1] = (h[n - 2] + h[n - 3]) * (h[n - 2] + 2.0 * h[n - 3]) / h[n - 3];
+        lower[k - 1] = (h[n - 3] - h[n - 2]) * (h[n - 3] + h[n - 2]) / h[n - 3];
+        solve_tridiagonal(lower, diagonal, upper, rhs);
+        for (std::size_t r = 0; r < k; ++r) {
+            m[r + 1] = rhs[r];
+        }
+        m[0] = m[1] + h[0] / h[1] * (m[1] - m[2]);
+        m[n - 1] = m[n - 2] + h[n - 2] / h[n - 3] * (m[n - 2] - m[n - 3]);
+    } else {
+        std::vector<double> lower(n, 0.0), diagonal(n, 1.0), upper(n, 0.0), rhs(n, 0.0);
+        for (std::size_t i = 1; i + 1 < n; ++i) {
+            lower[i] = h[i - 1];
+            diagonal[i] = 2.0 * (h[i - 1] + h[i]);
+            upper[i] = h[i];
+            rhs[i] = 6.0 * (slope[i] - slope[i - 1]);
+        }
+        if (boundary == Boundary::Clamped) {
+            // s'(x_0) = left_slope and s'(x_{n-1}) = right_slope
+            diagonal[0] = 2.0 * h[0];
+            upper[0] = h[0];
+            rhs[0] = 6.0 * (slope[0] - left_slope);
+            lower[n - 1] = h[n - 2];
+            diagonal[n - 1] = 2.0 * h[n - 2];
+            rhs[n - 1] = 6.0 * (right_slope - slope[n - 2]);
+        }
+        // natural: the first and last rows read m[0] = 0 and m[n-1] = 0
+        solve_tridiagonal(lower, diagonal, upper, rhs);
+        m = rhs;
+    }
+
+    segments.resize(n - 1);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        segments[i] = Segment{
+            y_nodes[i],
+            slope[i] - h[i] * (2.0 * m[i] + m[i + 1]) / 6.0,
+            m[i] / 2.0,
+            (m[i + 1] - m[i]) / (6.0 * h[i])
+        };
+    }
+}
+
+double CubicSpline::operator()(double x) const {
+    check_range(x);
+    std::size_t i = search.find(x_nodes, x);
+    const Segment& s = segments[i];
+    double t = x - x_nodes[i];
+    return s.a + t * (s.b + t * (s.c + t * s.d));
+}
+
+void CubicSpline::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("CubicSpline::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    check_range(xs, n);
+    std::size_t i = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        i = search.find_from(x_nodes, xs[k], i);
+        const Segment& s = segments[i];
+        double t = xs[k] - x_nodes[i];
+        out[k] = s.a + t * (s.b + t * (s.c + t * s.d));
+    }
+}
+
+PiecewisePolynomial CubicSpline::to_piecewise() const {
+    std::vector<std::vector<double>> coefficients(4, std::vector<double>(segments.size()));
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        coefficients[0][i] = segments[i].a;
+        coefficients[1][i] = segments[i].b;
+        coefficients[2][i] = segments[i].c;
+        coefficients[3][i] = segments[i].d;
+    }
+    return PiecewisePolynomial(x_nodes, coefficients);
+}
@@ -10,121 +10,394 @@
 #include <numeric>
 #include <variant>
 #include <optional>         
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <exception>
 #include <gsl/gsl_statistics.h>
 #include <boost/histogram.hpp>
 #include <boost/json.hpp>
 #include <map> 
+#include <unordered_map>
 #include "DataFrame.hpp"
+#include "DecompressingBuffer.hpp"
+#include "Parallel.hpp"
+#include "LinearInterpolator.hpp"
+#include "CubicSpline.hpp"
+#include "AllocationTracker.hpp"
+#include "Profiler.hpp"
 
 
 /* -------------------------------------------------------------------------- */
 /*                           DATA STRUCTURE METHODS                           */
 /* -------------------------------------------------------------------------- */
 
-void DataFrame::read_csv(const std::string& filename, char separator, bool has_header){
-    // Clear existing data
-    column_names.clear();
-    data.clear();
+DataFrame& DataFrame::operator=(DataFrame other) noexcept
+{
+    swap(other);
+    return *this;
+}
+
+void DataFrame::swap(DataFrame& other) noexcept
+{
+    column_names.swap(other.column_names);
+    column_index.swap(other.column_index);
+    string_pool.swap(other.string_pool);
+    data.swap(other.data);
+    encoded.swap(other.encoded);
+}
+
+void DataFrame::reset_string_pool()
+{
+    // the first block is large enough for a typical text column,
+    // the following ones grow geometrically
+    string_pool = std::make_shared<std::pmr::monotonic_buffer_resource>(1 << 16);
+}
+
+namespace {
+
+// deleter of the buffers created by share_column: it keeps the string arena
+// alive as long as the cells, and tells apart the cells that were allocated
+// by a dataframe, not const, from buffers received from elsewhere
+struct PooledCells {
+    std::shared_ptr<std::pmr::monotonic_buffer_resource> pool;
+
+    void operator()(ColumnType* cells) const
+    {
+        delete cells;
+    }
+};
+
+} // namespace
+
+ColumnBuffer DataFrame::share_column(ColumnType cells) const
+{
+    return ColumnBuffer(new ColumnType(std::move(cells)), PooledCells{string_pool});
+}
+
+ColumnType& DataFrame::mutable_column(std::size_t idx)
+{
+    // a buffer passed to add_column may point to a const object: only the
+    // buffers created by share_column are changed in place
+    if (data[idx].use_count() == 1 && std::get_deleter<PooledCells>(data[idx]) != nullptr) {
+        // the last owner: no other dataframe can reach the buffer any more, the fence
+        // orders the writes after the reads done by the owners that released it
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } else {
+        // the copied strings are allocated on the heap
+        data[idx] = share_column(*data[idx]);
+    }
+    // the cells were allocated by share_column as non-const, only shared as const
+    return const_cast<ColumnType&>(*data[idx]);
+}
 
+std::size_t DataFrame::n_rows() const
+{
+    if (data.empty()) {
+        return 0;
+    }
+    return encoded[0] ? encoded[0]->size() : data[0]->size();
+}
+
+std::optional<ColumnEncoding> DataFrame::decode_for_update(std::size_t idx)
+{
+    if (!encoded[idx]) {
+        return std::nullopt;
+    }
+    std::optional<ColumnEncoding> encoding = encoded[idx]->encoding();
+    data[idx] = share_column(encoded[idx]->decode());
+    encoded[idx].reset();
+    return encoding;
+}
+
+void DataFrame::restore_encoding(std::size_t idx, std::optional<ColumnEncoding> encoding)
+{
+    if (encoding) {
+        try {
+            encoded[idx] = std::make_shared<const EncodedColumn>(*data[idx], *encoding);
+        } catch (const std::invalid_argument&) {
+            // e.g. a constant column after fillna, or interpolated values
+            // with more decimals than a delta column can hold
+            encoded[idx] = std::make_shared<const EncodedColumn>(*data[idx], ColumnEncoding::Auto);
+        }
+        data[idx] = std::make_shared<const ColumnType>();   // release the cells
+    }
+}
+
+DataFrame::UpdateGuard::UpdateGuard(DataFrame& frame, std::size_t idx)
+    : frame(frame), idx(idx), encoding(frame.decode_for_update(idx)), exceptions(std::uncaught_exceptions())
+{
+}
+
+DataFrame::UpdateGuard::~UpdateGuard() noexcept(false)
+{
+    if (std::uncaught_exceptions() == exceptions) {
+        frame.restore_encoding(idx, encoding);
+        return;
+    }
+    // unwinding: a second exception cannot be thrown, the column at worst
+    // stays decoded with its values intact
+    try {
+        frame.restore_encoding(idx, encoding);
+    } catch (...) {
+    }
+}
+
+std::vector<const std::optional<DataType>*> DataFrame::block_cells(std::size_t begin, std::size_t end, std::vector<ColumnType>& decoded) const
+{
+    std::vector<const std::optional<DataType>*> cells(data.size());
+    decoded.resize(data.size());
+    for (std::size_t col = 0; col < data.size(); ++col) {
+        if (encoded[col]) {
+            decoded[col] = encoded[col]->decode(begin, end);
+            cells[col] = decoded[col].data();
+        } else {
+            cells[col] = data[col]->data() + begin;
+        }
+    }
+    return cells;
+}
+
+void DataFrame::encode_column(const std::string& name, ColumnEncoding encoding)
+{
+    AllocationTracker::Scope tracked("encode_column");
+    SCI_PROFILE_SCOPE("DataFrame::encode_column");
+    std::size_t idx = find_idx(name);
+    if (encoded[idx]) {
+        decode_column(name);
+    }
+    encoded[idx] = std::make_shared<const EncodedColumn>(*data[idx], encoding);
+    SCI_PROFILE_COUNT("rows", data[idx]->size());
+    data[idx] = std::make_shared<const ColumnType>();   // release the cells
+}
+
+void DataFrame::decode_column(const std::string& name)
+{
+    decode_for_update(find_idx(name));
+}
+
+std::optional<ColumnEncoding> DataFrame::get_encoding(const std::string& name) const
+{
+    const auto& column = encoded[find_idx(name)];
+    return column ? std::optional<ColumnEncoding>(column->encoding()) : std::nullopt;
+}
+
+void DataFrame::build_index()
+{
+    column_index.clear();
+    column_index.reserve(column_names.size());
+    for (std::size_t i = 0; i < column_names.size(); ++i) {
+        // emplace does not overwrite, so duplicated names resolve to the first column
+        column_index.emplace(column_names[i], i);
+    }
+}
+
+// read a record: a line, joined with the following ones while a quoted field
+// is open (a field written by write_csv may contain newlines)
+static bool read_record(std::istream& file, std::string& line, std::string& next)
+{
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    std::size_t quotes = std::count(line.begin(), line.end(), '"');
+    while (quotes % 2 == 1 && std::getline(file, next)) {
+        quotes += std::count(next.begin(), next.end(), '"');
+        line += '\n';
+        line += next;
+    }
+    return true;
+}
+
+// split a record on the separator, with the same rules of std::getline:
+// an empty line has no cells and a trailing separator does not open a new cell.
+// A field starting with a quote ends at the next single quote (RFC 4180, as
+// written by write_csv): it may contain the separator and newlines, and its
+// doubled quotes are unescaped into `unquoted`, where its view points
+static void split_line(const std::string& line, char separator, std::vector<std::string_view>& cells, std::string& unquoted)
+{
+    cells.clear();
+    if (line.find('"') == std::string::npos) {
+        std::size_t start{0};
+        while (start < line.size()) {
+            std::size_t end = line.find(separator, start);
+            if (end == std::string::npos) {
+                cells.emplace_back(line.data() + start, line.size() - start);
+                break;
+            }
+            cells.emplace_back(line.data() + start, end - start);
+            start = end + 1;
+        }
+        return;
+    }
+
+    // the unquoted fields are never longer than the line: no reallocation
+    // moves the characters the views point to
+    unquoted.clear();
+    unquoted.reserve(line.size());
+    std::size_t pos{0};
+    while (pos < line.size()) {
+        if (line[pos] != '"') {
+            std::size_t end = std::min(line.find(separator, pos), line.size());
+            cells.emplace_back(line.data() + pos, end - pos);
+            pos = end + 1;
+            continue;
+        }
+        std::size_t begin = unquoted.size();
+        for (++pos; pos < line.size(); ++pos) {
+            if (line[pos] == '"' && (pos + 1 == line.size() || line[pos + 1] != '"')) {
+                ++pos;      // the closing quote
+                break;
+            }
+            if (line[pos] == '"') {
+                ++pos;      // the first of two quotes
+            }
+            unquoted += line[pos];
+        }
+        // characters after the closing quote are kept, as in `"a"b`
+        for (; pos < line.size() && line[pos] != separator; ++pos) {
+            unquoted += line[pos];
+        }
+        cells.emplace_back(unquoted.data() + begin, unquoted.size() - begin);
+        ++pos;
+    }
+}
+
+void DataFrame::read_csv(const std::string& filename, char separator, bool has_header){
     // Open the file
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Could not open file: " + filename);
     }
+    read_csv(file, separator, has_header);
+}
+
+void DataFrame::read_csv(std::istream& input, char separator, bool has_header){
+    AllocationTracker::Scope tracked("read_csv");
+    SCI_PROFILE_SCOPE("DataFrame::read_csv");
+    // the current data is replaced only once the input is parsed: if the
+    // parsing throws, the dataframe is left unchanged
+    DataFrame parsed;
+    parsed.parse_csv(input, separator, has_header);
+    swap(parsed);
+}
+
+void DataFrame::parse_csv(std::istream& input, char separator, bool has_header)
+{
+    reset_string_pool();
+
+    // gzip or zstd input is decompressed by another thread while parsing
+    std::unique_ptr<DecompressingStream> decompressed;
+    std::istream& file = DecompressingStream::wrap(input, decompressed);
 
-    std::string line;
+    std::string line, next, unquoted;
+    // views on the cells of the current line, reused for every row
+    std::vector<std::string_view> cells;
+    std::size_t bytes{0};
         
     // Read header if true
     if (has_header) {
-        if (!std::getline(file, line)) {
+        if (!read_record(file, line, next)) {
             throw std::runtime_error("Empty CSV file");
         }
+        bytes += line.size() + 1;
 
-        std::istringstream header_stream(line);
-        std::string column_name;
-        
         // Parse header columns
-        while (std::getline(header_stream, column_name, separator)) {
-            column_names.push_back(column_name);
+        split_line(line, separator, cells, unquoted);
+        for (const auto& column_name : cells) {
+            column_names.emplace_back(column_name);
         }
     }
 
-    // Read all rows and store in raw_data
-    // raw_data is the transposed version of the row
-
-    std::vector<ColumnType> raw_data;
-    while (std::getline(file, line)) {
-        std::istringstream row_stream(line);
-        std::string cell;
-        ColumnType row_cells;
-
-        while (std::getline(row_stream, cell, separator)) {
-            // If empy cell put a null option
-            if (cell.empty()) {
-                row_cells.push_back(std::nullopt);
-            } 
-            else 
-            {
-                // try to convert the cell into a double
-                try {
-                    row_cells.push_back(std::stod(cell));
-                } catch (const std::invalid_argument&) {
-                    // if fails pass it as a string
-                    row_cells.push_back(cell);
-                }
+    // Read the rows and append every cell directly to its column
+    // (a file with a header and no rows gives empty columns)
+    std::vector<ColumnType> columns(column_names.size());
+    std::string cell;
+    while (read_record(file, line, next)) {
+        bytes += line.size() + 1;
+        split_line(line, separator, cells, unquoted);
+
+        // If no header was specified, create default column names
+        if (column_names.empty()) {
+            for (size_t i = 0; i < cells.size(); ++i) {
+                column_names.push_back("Column_" + std::to_string(i));
             }
         }
-        // Add row to raw data
-        raw_data.push_back(row_cells);
-    }
-
-    // If no header was specified, create default column names
-    if (column_names.empty()) {
-        for (size_t i = 0; i < raw_data[0].size(); ++i) {
-            column_names.push_back("Column_" + std::to_string(i));
+        if (columns.empty()) {
+            columns.resize(column_names.size());
         }
-    }
 
-    // Transpose and convert raw_data to column-based storage
-    if (!raw_data.empty()) {
-        // Initialize columns
-        data.resize(column_names.size());
-        for (auto& column : data) {
-            column.clear();
-        }
-
-        // Populate columns
-        for (const auto& row : raw_data) {
-            for (size_t col = 0; col < column_names.size(); ++col) {
-                if (col < row.size()) {                    
-                    data[col].push_back(row[col]);
-                } else {
-                    // If row is shorter, push null option
-                    data[col].push_back(std::nullopt);
-                }
+        for (size_t col = 0; col < column_names.size(); ++col) {
+            // If empty cell (or the row is shorter) put a null option
+            if (col >= cells.size() || cells[col].empty()) {
+                columns[col].emplace_back(std::nullopt);
+                continue;
+            }
+            // try to convert the cell into a double
+            cell.assign(cells[col]);
+            try {
+                columns[col].emplace_back(std::stod(cell));
+            } catch (const std::invalid_argument&) {
+                SCI_PROFILE_COUNT("conversion_exceptions", 1);
+                // if fails store it as a string, inside the arena
+                columns[col].emplace_back(std::in_place, std::in_place_type<StringType>, cells[col], string_pool.get());
             }
         }
     }
+
+    for (auto& column : columns) {
+        data.push_back(share_column(std::move(column)));
+    }
+    encoded.resize(data.size());
+    build_index();
+    SCI_PROFILE_COUNT("rows", n_rows());
+    SCI_PROFILE_COUNT("bytes", bytes);
 }
 
 void DataFrame::read_json(const std::string& filename) {
-    // Clear existing data
-    column_names.clear();
-    data.clear();
-
     // Read file contents
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Could not open file: " + filename);
     }
+    read_json(file);
+}
+
+void DataFrame::read_json(std::istream& input) {
+    AllocationTracker::Scope tracked("read_json");
+    SCI_PROFILE_SCOPE("DataFrame::read_json");
+    // as read_csv, the dataframe is left unchanged if the parsing throws
+    DataFrame parsed;
+    parsed.parse_json(input);
+    swap(parsed);
+}
 
-    // Parse entire file contents
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string jsonStr = buffer.str();
+void DataFrame::parse_json(std::istream& input)
+{
+    reset_string_pool();
+
+    // gzip or zstd input is decompressed by another thread while reading
+    std::unique_ptr<DecompressingStream> decompressed;
+    std::istream& file = DecompressingStream::wrap(input, decompressed);
+
+    // Parse entire file contents, read by chunks (unlike operator<< on the
+    // stream buffer, read() reports the decompression errors)
+    std::string jsonStr;
+    std::vector<char> chunk(1 << 16);
+    while (file.read(chunk.data(), chunk.size()) || file.gcount() > 0) {
+        jsonStr.append(chunk.data(), static_cast<std::size_t>(file.gcount()));
+    }
+    SCI_PROFILE_COUNT("bytes", jsonStr.size());
 
     // Parse JSON 
-    boost::json::value parsedJson = boost::json::parse(jsonStr);
+    boost::json::value parsedJson = [&jsonStr]() {
+        SCI_PROFILE_SCOPE("boost::json::parse");
+        return boost::json::parse(jsonStr);
+    }();
 
     // Ensure it's an array
     if (!parsedJson.is_array()) {
@@ -143,8 +416,10 @@ void DataFrame::read_json(const std::string& filename) {
         column_names.push_back(std::string(key));
     }
 
+    build_index();
+
     // Prepare columns with the correct size
-    data.resize(column_names.size());
+    std::vector<ColumnType> columns(column_names.size());
 
     // Populate data
     for (const auto& jsonRow : jsonArray) {
@@ -158,7 +433,7 @@ void DataFrame::read_json(const std::string& filename) {
             auto it = rowObj.find(colName);
             if (it == rowObj.end()) {
                 // Column not found, add null
-                data[colIndex].push_back(std::optional<DataType>{std::nullopt});
+                columns[colIndex].push_back(std::optional<DataType>{std::nullopt});
                 continue;
             }
 
@@ -166,45 +441,260 @@ void DataFrame::read_json(const std::string& filename) {
             const boost::json::value& value = it->value();
             
             if (value.is_double()) {
-                data[colIndex].push_back(value.as_double());
+                columns[colIndex].push_back(value.as_double());
             }
             else if (value.is_string()) {
-                std::string strValue = std::string(value.as_string());
+                std::string_view strValue = value.as_string();
                 if (strValue.empty()) {
                     // Treat empty strings as null
-                    data[colIndex].push_back(std::optional<DataType>{std::nullopt});
+                    columns[colIndex].push_back(std::optional<DataType>{std::nullopt});
                 } else {
-                    data[colIndex].push_back(strValue);
+                    // copy the characters straight into the arena
+                    columns[colIndex].emplace_back(std::in_place, std::in_place_type<StringType>, strValue, string_pool.get());
                 }
             }
             else {
                 // Unsupported type, add null
-                data[colIndex].push_back(std::optional<DataType>{std::nullopt});
+                columns[colIndex].push_back(std::optional<DataType>{std::nullopt});
+            }
+        }
+    }
+
+    for (auto& column : columns) {
+        data.push_back(share_column(std::move(column)));
+    }
+    encoded.resize(data.size());
+    SCI_PROFILE_COUNT("rows", jsonArray.size());
+}
+
+// append a number with the shortest representation that reads back to the same value
+static void append_double(std::string& out, double value, bool json)
+{
+    // JSON has no literal for nan and infinity
+    if (json && !std::isfinite(value)) {
+        out += "null";
+        return;
+    }
+    char buffer[32];
+    char* end = std::to_chars(buffer, buffer + sizeof(buffer), value).ptr;
+    out.append(buffer, end);
+    // read_json only accepts floating point numbers, so keep them recognisable
+    if (json && std::find_if(buffer, end, [](char c) { return c == '.' || c == 'e'; }) == end) {
+        out += ".0";
+    }
+}
+
+// append a CSV field, quoting it only if it contains a special character
+static void append_csv_field(std::string& out, std::string_view field, char separator)
+{
+    const char special[] = {separator, '"', '\n', '\r'};
+    if (field.find_first_of(std::string_view(special, sizeof(special))) == std::string_view::npos) {
+        out += field;
+        return;
+    }
+    out += '"';
+    for (char c : field) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+// append a quoted and escaped JSON string
+static void append_json_string(std::string& out, std::string_view field)
+{
+    static const char hex[] = "0123456789abcdef";
+    out += '"';
+    for (char c : field) {
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xf];
+                    out += hex[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    out += '"';
+}
+
+// format the rows in blocks of consecutive rows, several blocks in parallel,
+// and write the blocks to the file in order: format(begin, end, out) appends
+// the text of the rows [begin, end) to out. Return the number of bytes written
+template <typename Formatter>
+static std::size_t write_in_blocks(std::ofstream& file, std::size_t n_rows, Formatter format)
+{
+    constexpr std::size_t rows_per_block{1 << 14};
+    const std::size_t blocks_per_batch{4 * std::size_t{parallel::thread_count()}};
+
+    // the buffers are reused by every batch, so they are allocated only once
+    std::vector<std::string> blocks(blocks_per_batch);
+    std::size_t bytes{0};
+    for (std::size_t first = 0; first < n_rows; first += rows_per_block * blocks_per_batch) {
+        std::size_t n_blocks = std::min(blocks_per_batch, (n_rows - first + rows_per_block - 1) / rows_per_block);
+
+        parallel::for_chunks(n_blocks, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t k = begin; k < end; ++k) {
+                std::size_t row_begin = first + k * rows_per_block;
+                blocks[k].clear();
+                format(row_begin, std::min(n_rows, row_begin + rows_per_block), blocks[k]);
             }
+        });
+
+        for (std::size_t k = 0; k < n_blocks; ++k) {
+            file.write(blocks[k].data(), blocks[k].size());
+            bytes += blocks[k].size();
         }
     }
+    return bytes;
 }
 
-const std::vector<ColumnType>& DataFrame::get_data() const 
+void DataFrame::write_csv(const std::string& filename, char separator) const
 {
-    return data;
+    AllocationTracker::Scope tracked("write_csv");
+    SCI_PROFILE_SCOPE("DataFrame::write_csv");
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    std::string header;
+    for (std::size_t col = 0; col < column_names.size(); ++col) {
+        if (col > 0) {
+            header += separator;
+        }
+        append_csv_field(header, column_names[col], separator);
+    }
+    header += '\n';
+    file.write(header.data(), header.size());
+
+    std::size_t bytes = write_in_blocks(file, n_rows(), [&](std::size_t begin, std::size_t end, std::string& out) {
+        std::vector<ColumnType> decoded;
+        auto columns = block_cells(begin, end, decoded);
+        for (std::size_t row = begin; row < end; ++row) {
+            for (std::size_t col = 0; col < data.size(); ++col) {
+                if (col > 0) {
+                    out += separator;
+                }
+                const auto& cell = columns[col][row - begin];
+                if (!cell) {
+                    continue;
+                }
+                if (std::holds_alternative<double>(*cell)) {
+                    append_double(out, std::get<double>(*cell), false);
+                } else {
+                    append_csv_field(out, std::get<StringType>(*cell), separator);
+                }
+            }
+            out += '\n';
+        }
+    });
+
+    if (!file) {
+        throw std::runtime_error("Error while writing file: " + filename);
+    }
+    SCI_PROFILE_COUNT("rows", n_rows());
+    SCI_PROFILE_COUNT("bytes", bytes);
+}
+
+void DataFrame::write_json(const std::string& filename, bool ndjson) const
+{
+    AllocationTracker::Scope tracked("write_json");
+    SCI_PROFILE_SCOPE("DataFrame::write_json");
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    // the keys are the same for every row, escape them once
+    std::vector<std::string> keys(data.size());
+    for (std::size_t col = 0; col < data.size(); ++col) {
+        append_json_string(keys[col], column_names[col]);
+        keys[col] += ':';
+    }
+
+    if (!ndjson) {
+        file << "[\n";
+    }
+
+    std::size_t bytes = write_in_blocks(file, n_rows(), [&](std::size_t begin, std::size_t end, std::string& out) {
+        std::vector<ColumnType> decoded;
+        auto columns = block_cells(begin, end, decoded);
+        for (std::size_t row = begin; row < end; ++row) {
+            if (!ndjson && row > 0) {
+                out += ",\n";
+            }
+            out += '{';
+            for (std::size_t col = 0; col < data.size(); ++col) {
+                if (col > 0) {
+                    out += ',';
+                }
+                out += keys[col];
+                const auto& cell = columns[col][row - begin];
+                if (!cell) {
+                    out += "null";
+                } else if (std::holds_alternative<double>(*cell)) {
+                    append_double(out, std::get<double>(*cell), true);
+                } else {
+                    append_json_string(out, std::get<StringType>(*cell));
+                }
+            }
+            out += '}';
+            if (ndjson) {
+                out += '\n';
+            }
+        }
+    });
+
+    if (!ndjson) {
+        file << (n_rows() > 0 ? "\n]\n" : "]\n");
+    }
+
+    if (!file) {
+        throw std::runtime_error("Error while writing file: " + filename);
+    }
+    SCI_PROFILE_COUNT("rows", n_rows());
+    SCI_PROFILE_COUNT("bytes", bytes);
+}
+
+std::vector<ColumnBuffer> DataFrame::get_data() const
+{
+    std::vector<ColumnBuffer> buffers(data);
+    for (std::size_t idx = 0; idx < data.size(); ++idx)
+    {
+        // the decoded cells live as long as the encoded column
+        if (encoded[idx])
+        {
+            buffers[idx] = ColumnBuffer(encoded[idx], &encoded[idx]->cells());
+        }
+    }
+    return buffers;
 }
 
 // first = nrows, second = ncols
 std::pair<unsigned int,unsigned int> DataFrame::shape() const 
 {
-    std::pair<unsigned int,unsigned int> dims=std::make_pair(data[0].size(),data.size());
+    std::pair<unsigned int,unsigned int> dims=std::make_pair(n_rows(),data.size());
     return dims;
 }
 
 const ColumnType& DataFrame::get_column(const size_t column) const 
 {   
-    if (column > column_names.size())
+    if (column >= data.size())
     {
         throw std::invalid_argument("Error in get_column: column index out of range");
     }
-    
-    return data[column];
+    // an encoded column is decoded once, on the first request
+    return encoded[column] ? encoded[column]->cells() : *data[column];
 }
 
 const std::vector<std::string>& DataFrame::get_header() const 
@@ -212,17 +702,91 @@ const std::vector<std::string>& DataFrame::get_header() const
     return column_names;
 }
 
-void DataFrame::add_column(const std::string& column_name, const ColumnType& new_col) {
+void DataFrame::add_column(const std::string& column_name, ColumnType new_col) {
+    add_column(column_name, share_column(std::move(new_col)));
+}
+
+void DataFrame::add_column(const std::string& column_name, ColumnBuffer new_col) {
+    if (!new_col) {
+        throw std::invalid_argument("Error in add_column: the column buffer is empty");
+    }
 // If data is not empty, check that the new column has the same length
-    if (!data.empty() && new_col.size() != data[0].size()) {
+    if (!data.empty() && new_col->size() != n_rows()) {
         throw std::invalid_argument("Error in add_column: New column must have the same number of rows as existing data");
     }
     
     // Add the column name
     column_names.push_back(column_name);
+    column_index.emplace(column_name, column_names.size() - 1);
     
     // Add the column data
-    data.push_back(new_col);
+    data.push_back(std::move(new_col));
+    encoded.emplace_back();
+}
+
+DataFrame DataFrame::select(const std::vector<std::string>& names) const
+{
+    DataFrame selected;
+    selected.string_pool = string_pool;
+    for (const auto& name : names) {
+        std::size_t idx = find_idx(name);
+        selected.column_names.push_back(column_names[idx]);
+        selected.data.push_back(data[idx]);
+        selected.encoded.push_back(encoded[idx]);
+    }
+    selected.build_index();
+    return selected;
+}
+
+DataFrame DataFrame::concat(const std::vector<DataFrame>& frames)
+{
+    AllocationTracker::Scope tracked("concat");
+    SCI_PROFILE_SCOPE("DataFrame::concat");
+    // the union of the columns, in order of first appearance
+    DataFrame result;
+    for (const auto& frame : frames) {
+        for (const auto& name : frame.column_names) {
+            if (result.column_index.emplace(name, result.column_names.size()).second) {
+                result.column_names.push_back(name);
+            }
+        }
+    }
+    std::size_t total_rows{0};
+    for (const auto& frame : frames) {
+        total_rows += frame.n_rows();
+    }
+
+    // the strings are copied once more, into the arena of the result
+    result.reset_string_pool();
+    std::pmr::memory_resource* pool = result.string_pool.get();
+    for (const auto& name : result.column_names) {
+        ColumnType column;
+        column.reserve(total_rows);
+        for (const auto& frame : frames) {
+            auto it = frame.column_index.find(name);
+            if (it == frame.column_index.end() || it->second >= frame.data.size()) {
+                column.resize(column.size() + frame.n_rows());     // missing in this frame
+                continue;
+            }
+            ColumnType decoded;
+            if (frame.encoded[it->second]) {
+                decoded = frame.encoded[it->second]->decode();
+            }
+            const ColumnType& cells = frame.encoded[it->second] ? decoded : *frame.data[it->second];
+            for (const auto& cell : cells) {
+                if (cell && std::holds_alternative<StringType>(*cell)) {
+                    column.emplace_back(std::in_place, std::in_place_type<StringType>, std::get<StringType>(*cell), pool);
+                } else {
+                    column.push_back(cell);
+                }
+            }
+        }
+        result.data.push_back(result.share_column(std::move(column)));
+    }
+    result.encoded.resize(result.data.size());
+    SCI_PROFILE_COUNT("frames", frames.size());
+    SCI_PROFILE_COUNT("rows", total_rows);
+    return result;
 }
 
 void DataFrame::set_header(const std::vector<std::string>& new_header){
@@ -233,138 +797,656 @@ void DataFrame::set_header(const std::vector<std::string>& new_header){
     
     column_names.clear();
     column_names = new_header;
+    build_index();
 }
 
 void DataFrame::drop_row(const unsigned int& row)
 {   
-    if (row > data[0].size())
+    if (row > n_rows())
     {
         throw std::invalid_argument("Error in drop_row: index out of range");
     }
-    for (auto &&col : data)
+    for (std::size_t idx = 0; idx < data.size(); ++idx)
     {
-        col.erase((col.begin()+row));
+        UpdateGuard guard(*this, idx);
+        ColumnType& column = mutable_column(idx);
+        column.erase((column.begin()+row));
     }
     
 }
 
 unsigned int DataFrame::find_idx(const std::string& name) const {
-    // Find the attribute
-    auto it = std::find(column_names.begin(), column_names.end(), name);
-    if (it != column_names.end()) {
-        // Calculate the index by subtracting the beginning iterator from the found iterator
-        return std::distance(column_names.begin(), it);
-    } else {
-        std::cout << "Attribute not found\n";
-        throw std::invalid_argument("Attribute not found");
+    // Find the attribute in the hash index
+    auto it = column_index.find(name);
+    if (it == column_index.end()) {
+        throw std::invalid_argument("Attribute not found: " + name);
+    }
+    return it->second;
+}
+
+DataFrame::ColumnHandle DataFrame::get_handle(const std::string& name) const {
+    return ColumnHandle{find_idx(name)};
+}
+
+void DataFrame::drop_col(const std::string& name)
+{   
+    // Find the index once and store it
+    unsigned int idx = find_idx(name);
+    
+    // Erase the column name
+    column_names.erase(column_names.begin() + idx);
+    
+    // Erase the corresponding column data
+    data.erase(data.begin() + idx);
+    encoded.erase(encoded.begin() + idx);
+
+    // the following columns have shifted, rebuild the index
+    build_index();
+}
+
+std::vector<double> DataFrame::get_double_column(const std::string& name) const{
+    return get_double_column(get_handle(name));
+}
+
+std::vector<double> DataFrame::get_double_column(ColumnHandle column) const{
+    AllocationTracker::Scope tracked("get_double_column");
+    SCI_PROFILE_SCOPE("DataFrame::get_double_column");
+    if (encoded[column.index])
+    {
+        SCI_PROFILE_COUNT("rows", encoded[column.index]->size());
+        return encoded[column.index]->values();
+    }
+    SCI_PROFILE_COUNT("rows", data[column.index]->size());
+
+    std::vector<double> double_values{};
+    double_values.reserve(data[column.index]->size());
+    
+    for (const auto &cell : *data[column.index])
+    {
+        if (cell && std::holds_alternative<double>(*cell))
+        {
+            double_values.push_back(std::get<double>(*cell));
+        }   
+    }
+    
+    return double_values;
+}
+
+std::vector<std::string> DataFrame::get_string_column(const std::string& name) const{
+    std::vector<std::string> string_values{};
+    for (const auto &cell : *data[find_idx(name)])
+    {
+        if (cell && std::holds_alternative<StringType>(*cell))
+        {
+            string_values.emplace_back(std::get<StringType>(*cell));
+        }
+    }
+    return string_values;
+}
+
+bool DataFrame::is_numeric(const std::string& name) const{
+    return is_numeric(get_handle(name));
+}
+
+bool DataFrame::is_numeric(ColumnHandle column) const{
+    for (const auto &cell : *data[column.index])
+    {
+        // null cells do not say anything about the type
+        if (cell && std::holds_alternative<StringType>(*cell))
+        { 
+            return false;
+        } 
+    }
+    return true;
+}
+
+void DataFrame::table_nan() const
+{
+    unsigned int spacing{formatting_width() +3};
+    for (std::size_t idx = 0; idx < column_names.size(); ++idx)
+    {
+        const auto& name = column_names[idx];
+        unsigned int cnt{0};
+        if (encoded[idx])
+        {
+            cnt = encoded[idx]->size() - encoded[idx]->count();
+        }
+        for (auto &&value : *data[idx])
+        {
+            if (!value.has_value())
+            {
+                cnt++;
+            }   
+        }
+        std::cout << std::setw(spacing) << std::left << name << std::setw(spacing) << std::left << cnt << std::endl;
+    }
+}
+
+void DataFrame::drop_row_nan()
+{
+    AllocationTracker::Scope tracked("drop_row_nan");
+    SCI_PROFILE_SCOPE("DataFrame::drop_row_nan");
+    if (data.empty()) {
+        return;
+    }
+
+    // Work on the cells, the encoded columns are encoded again at the end
+    std::deque<UpdateGuard> guards;
+    for (std::size_t idx = 0; idx < data.size(); ++idx) {
+        guards.emplace_back(*this, idx);
+    }
+
+    // Number of rows (assuming all columns have the same number of rows)
+    std::size_t num_rows = data[0]->size();
+
+    // Vector to mark rows that should be removed
+    std::vector<unsigned int> rows_to_drop;
+
+    // Identify rows with any `std::nullopt`
+    for (const auto& column : data) {
+        for (std::size_t i = 0; i < num_rows; ++i) {
+            if (!(*column)[i].has_value()) {
+                rows_to_drop.push_back(i);
+            }
+        }
+    }
+
+    // sort is necessary to rescale the index correctly, and a row with
+    // more than one nan must be dropped only once
+    std::sort(rows_to_drop.begin(), rows_to_drop.end());
+    rows_to_drop.erase(std::unique(rows_to_drop.begin(), rows_to_drop.end()), rows_to_drop.end());
+    unsigned int cnt{0};
+    for (auto &&idx : rows_to_drop)
+    {
+        drop_row(idx-cnt);  // everytime a row is dropped, rescale the idx
+        cnt +=1;    
+    }
+    SCI_PROFILE_COUNT("rows", num_rows);
+    SCI_PROFILE_COUNT("rows_dropped", rows_to_drop.size());
+}
+
+void DataFrame::fillna(const std::string& name, double value)
+{
+    std::size_t idx = find_idx(name);
+    UpdateGuard guard(*this, idx);
+    for (auto& cell : mutable_column(idx))
+    {
+        if (!cell.has_value())
+        {
+            cell = value;
+        }
+    }
+}
+
+void DataFrame::interpolate_missing(const std::string& name, FillMethod method, const std::string& by)
+{
+    AllocationTracker::Scope tracked("interpolate_missing");
+    SCI_PROFILE_SCOPE("DataFrame::interpolate_missing");
+    std::size_t idx = find_idx(name);
+    UpdateGuard guard(*this, idx);
+    // only read until the interpolated values are written: a shared buffer is
+    // copied just if there is something to fill
+    const ColumnType& column = *data[idx];
+
+    // an encoded abscissa column is decoded in a temporary copy
+    ColumnType by_decoded;
+    const ColumnType* by_column{nullptr};
+    if (!by.empty())
+    {
+        std::size_t by_idx = find_idx(by);
+        if (encoded[by_idx])
+        {
+            by_decoded = encoded[by_idx]->decode();
+        }
+        by_column = encoded[by_idx] ? &by_decoded : data[by_idx].get();
+    }
+
+    // Split the rows in one pass: the valid values become the nodes, the
+    // nulls and NaN values the queries (rows without abscissa are skipped)
+    std::vector<double> x_known, y_known, x_missing;
+    std::vector<std::size_t> rows_missing;
+    double previous = -std::numeric_limits<double>::infinity();
+    for (std::size_t row = 0; row < column.size(); ++row)
+    {
+        double x = static_cast<double>(row);
+        if (by_column != nullptr)
+        {
+            const auto& x_cell = (*by_column)[row];
+            if (!x_cell || !std::holds_alternative<double>(*x_cell))
+            {
+                continue;
+            }
+            x = std::get<double>(*x_cell);
+            // both the nodes and the queries must be in order
+            if (!std::isfinite(x) || !(x > previous))
+            {
+                throw std::invalid_argument("ERROR in function interpolate_missing(): the abscissa column must be finite and strictly increasing.");
+            }
+            previous = x;
+        }
+
+        const auto& cell = column[row];
+        if (cell && !std::holds_alternative<double>(*cell))
+        {
+            throw std::invalid_argument("ERROR in function interpolate_missing(): column " + name + " is not numeric.");
+        }
+        // the cells parsed from "nan" are missing values as well, they must
+        // not become nodes
+        if (!cell || std::isnan(std::get<double>(*cell)))
+        {
+            x_missing.push_back(x);
+            rows_missing.push_back(row);
+        }
+        else
+        {
+            x_known.push_back(x);
+            y_known.push_back(std::get<double>(*cell));
+        }
+    }
+
+    if (x_missing.empty())
+    {
+        return;
+    }
+    if (x_known.size() < 2)
+    {
+        throw std::runtime_error("ERROR in function interpolate_missing(): at least two valid values are needed.");
+    }
+
+    // Only the nans between the first and the last valid value can be interpolated:
+    // with increasing abscissas they are a contiguous range of the queries
+    auto first = std::lower_bound(x_missing.begin(), x_missing.end(), x_known.front());
+    auto last = std::upper_bound(first, x_missing.end(), x_known.back());
+    std::size_t offset = std::distance(x_missing.begin(), first);
+    std::size_t n = std::distance(first, last);
+
+    // A single interpolator for all the gaps, evaluated in one forward walk
+    std::vector<double> values(n);
+    switch (method)
+    {
+    case FillMethod::Linear:
+        LinearInterpolator(x_known, y_known).evaluate(x_missing.data() + offset, values.data(), n);
+        break;
+    case FillMethod::Spline:
+        CubicSpline(x_known, y_known).evaluate(x_missing.data() + offset, values.data(), n);
+        break;
+    }
+
+    ColumnType& filled = mutable_column(idx);
+    for (std::size_t k = 0; k < n; ++k)
+    {
+        filled[rows_missing[offset + k]] = values[k];
+    }
+    SCI_PROFILE_COUNT("rows", filled.size());
+    SCI_PROFILE_COUNT("values_filled", n);
+}
+
+// heap bytes of a string outside the object, 0 if it fits in the inline buffer
+static std::size_t string_heap_bytes(const StringType& s)
+{
+    const char* object = reinterpret_cast<const char*>(&s);
+    std::less<const char*> before;
+    bool inline_buffer = !before(s.data(), object) && before(s.data(), object + sizeof(s));
+    return inline_buffer ? 0 : s.capacity() + 1;
+}
+
+std::vector<std::size_t> DataFrame::memory_usage() const
+{
+    std::vector<std::size_t> bytes(data.size(), 0);
+    for (std::size_t idx = 0; idx < data.size(); ++idx)
+    {
+        bytes[idx] = data[idx]->capacity() * sizeof(std::optional<DataType>);
+        for (const auto& cell : *data[idx])
+        {
+            if (cell && std::holds_alternative<StringType>(*cell))
+            {
+                bytes[idx] += string_heap_bytes(std::get<StringType>(*cell));
+            }
+        }
+        if (encoded[idx])
+        {
+            bytes[idx] += encoded[idx]->memory_usage();
+        }
+    }
+    return bytes;
+}
+
+unsigned int DataFrame:: formatting_width() const
+{
+    // Determine the maximum length of name for formatting the output
+    int max_name_len{0};
+    for (const auto& name : column_names) {
+        max_name_len = std::max(max_name_len, static_cast<int>(name.length()));
+    }
+    return max_name_len;
+}
+
+/* -------------------------------------------------------------------------- */
+/*                          ARROW C DATA INTERFACE                            */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// what an exported schema node owns
+struct ExportedSchema {
+    std::string format;
+    std::string name;
+    std::vector<ArrowSchema> children;
+    std::vector<ArrowSchema*> child_pointers;
+};
+
+// what an exported array node owns: its own buffers, or a reference to shared ones
+struct ExportedArray {
+    std::vector<const void*> buffers;
+    std::vector<ArrowArray> children;
+    std::vector<ArrowArray*> child_pointers;
+    std::shared_ptr<const void> owner;
+    std::vector<double> values;
+    std::vector<std::uint64_t> validity;
+    std::vector<std::int32_t> offsets;
+    std::vector<std::int64_t> large_offsets;
+    std::string chars;
+};
+
+void release_schema(ArrowSchema* schema)
+{
+    auto* exported = static_cast<ExportedSchema*>(schema->private_data);
+    // the consumer may have moved some children out, they are marked as released
+    for (ArrowSchema& child : exported->children) {
+        if (child.release != nullptr) {
+            child.release(&child);
+        }
     }
+    delete exported;
+    schema->release = nullptr;
 }
 
-void DataFrame::drop_col(const std::string& name)
-{   
-    // Find the index once and store it
-    unsigned int idx = find_idx(name);
-    
-    // Erase the column name
-    column_names.erase(column_names.begin() + idx);
-    
-    // Erase the corresponding column data
-    data.erase(data.begin() + idx);
+void release_array(ArrowArray* array)
+{
+    auto* exported = static_cast<ExportedArray*>(array->private_data);
+    for (ArrowArray& child : exported->children) {
+        if (child.release != nullptr) {
+            child.release(&child);
+        }
+    }
+    delete exported;
+    array->release = nullptr;
 }
 
-std::vector<double> DataFrame::get_double_column(const std::string& name) const{
-    std::vector<double> double_values{};
-    
-    for (const auto &cell : data[find_idx(name)])
-    {
-        if (cell && std::holds_alternative<double>(*cell))
-        {
-            double_values.push_back(std::get<double>(*cell));
-        }   
+void init_schema(ArrowSchema* schema, ExportedSchema* exported, std::int64_t flags)
+{
+    schema->format = exported->format.c_str();
+    schema->name = exported->name.c_str();
+    schema->metadata = nullptr;
+    schema->flags = flags;
+    schema->n_children = static_cast<std::int64_t>(exported->children.size());
+    for (ArrowSchema& child : exported->children) {
+        exported->child_pointers.push_back(&child);
     }
-    
-    return double_values;
+    schema->children = exported->child_pointers.empty() ? nullptr : exported->child_pointers.data();
+    schema->dictionary = nullptr;
+    schema->release = release_schema;
+    schema->private_data = exported;
 }
 
-std::vector<std::string> DataFrame::get_string_column(const std::string& name) const{
-    std::vector<std::string> string_values{};
-    for (const auto &cell : data[find_idx(name)])
-    {
-        if (cell && std::holds_alternative<std::string>(*cell))
-        {
-            string_values.push_back(std::get<std::string>(*cell));
-        }
+void init_array(ArrowArray* array, ExportedArray* exported, std::int64_t length, std::int64_t null_count)
+{
+    array->length = length;
+    array->null_count = null_count;
+    array->offset = 0;
+    array->n_buffers = static_cast<std::int64_t>(exported->buffers.size());
+    array->buffers = exported->buffers.data();
+    array->n_children = static_cast<std::int64_t>(exported->children.size());
+    for (ArrowArray& child : exported->children) {
+        exported->child_pointers.push_back(&child);
     }
-    return string_values;
+    array->children = exported->child_pointers.empty() ? nullptr : exported->child_pointers.data();
+    array->dictionary = nullptr;
+    array->release = release_array;
+    array->private_data = exported;
 }
 
-bool DataFrame::is_numeric(const std::string& name) const{
-    for (const auto &cell : data[find_idx(name)])
-    {
-        if (std::holds_alternative<std::string>(*cell))
-        { 
-            return false;
-        } 
-    }
-    return true;
+// bit `row` of an Arrow validity bitmap (nullptr: every row is valid)
+bool arrow_is_valid(const void* bitmap, std::int64_t row)
+{
+    return bitmap == nullptr || ((static_cast<const std::uint8_t*>(bitmap)[row / 8] >> (row % 8)) & 1);
 }
 
-void DataFrame::table_nan() const
+// copy the bits [begin, begin + rows) of an Arrow validity bitmap in 64-bit words,
+// empty if every row is valid
+std::vector<std::uint64_t> copy_validity(const void* bitmap, std::int64_t begin, std::int64_t rows)
 {
-    unsigned int spacing{formatting_width() +3};
-    for (auto &&name : column_names)
-    {
-        unsigned int cnt{0};
-        for (auto &&value : data[find_idx(name)])
-        {
-            if (!value.has_value())
-            {
-                cnt++;
-            }   
+    std::vector<std::uint64_t> validity;
+    if (bitmap == nullptr) {
+        return validity;
+    }
+    validity.assign((rows + 63) / 64, 0);
+    if (begin % 8 == 0) {
+        std::memcpy(validity.data(), static_cast<const std::uint8_t*>(bitmap) + begin / 8, (rows + 7) / 8);
+    } else {
+        for (std::int64_t row = 0; row < rows; ++row) {
+            if (arrow_is_valid(bitmap, begin + row)) {
+                validity[row / 64] |= std::uint64_t{1} << (row % 64);
+            }
         }
-        std::cout << std::setw(spacing) << std::left << name << std::setw(spacing) << std::left << cnt << std::endl;
     }
+    return validity;
 }
 
-void DataFrame::drop_row_nan()
+// value of a row of a numeric Arrow array, given its format
+double arrow_number(const char* format, const void* values, std::int64_t row)
 {
-    if (data.empty()) {
-        return;
+    switch (format[0]) {
+        case 'g': return static_cast<const double*>(values)[row];
+        case 'f': return static_cast<const float*>(values)[row];
+        case 'c': return static_cast<const std::int8_t*>(values)[row];
+        case 'C': return static_cast<const std::uint8_t*>(values)[row];
+        case 's': return static_cast<const std::int16_t*>(values)[row];
+        case 'S': return static_cast<const std::uint16_t*>(values)[row];
+        case 'i': return static_cast<const std::int32_t*>(values)[row];
+        case 'I': return static_cast<const std::uint32_t*>(values)[row];
+        case 'l': return static_cast<double>(static_cast<const std::int64_t*>(values)[row]);
+        case 'L': return static_cast<double>(static_cast<const std::uint64_t*>(values)[row]);
+        default: return 0.0;
     }
+}
 
-    // Number of rows (assuming all columns have the same number of rows)
-    std::size_t num_rows = data[0].size();
+} // namespace
 
-    // Vector to mark rows that should be removed
-    std::vector<unsigned int> rows_to_drop;
+void DataFrame::export_arrow(ArrowArray* array, ArrowSchema* schema) const
+{
+    SCI_PROFILE_SCOPE("DataFrame::export_arrow");
+    const std::size_t rows = n_rows();
+    auto parent_schema = std::make_unique<ExportedSchema>();
+    auto parent_array = std::make_unique<ExportedArray>();
+    parent_schema->format = "+s";
+    parent_schema->children.resize(data.size());
+    parent_array->buffers = {nullptr};
+    parent_array->children.resize(data.size());
+    std::size_t shared_columns{0};
+
+    for (std::size_t idx = 0; idx < data.size(); ++idx) {
+        auto child_schema = std::make_unique<ExportedSchema>();
+        auto child_array = std::make_unique<ExportedArray>();
+        child_schema->name = column_names[idx];
+        std::int64_t null_count{0};
+
+        if (encoded[idx] && encoded[idx]->plain_values() != nullptr) {
+            // share the buffers of the encoded column
+            child_schema->format = "g";
+            child_array->buffers = {encoded[idx]->validity_bitmap(), encoded[idx]->plain_values()};
+            child_array->owner = encoded[idx]->buffers_owner();
+            null_count = static_cast<std::int64_t>(rows - encoded[idx]->count());
+            ++shared_columns;
+        } else {
+            ColumnType decoded;
+            if (encoded[idx]) {
+                decoded = encoded[idx]->decode();
+            }
+            const ColumnType& cells = encoded[idx] ? decoded : *data[idx];
+            bool has_strings = std::any_of(cells.begin(), cells.end(), [](const auto& cell) {
+                return cell && std::holds_alternative<StringType>(*cell);
+            });
+
+            ExportedArray& a = *child_array;
+            a.validity.assign((rows + 63) / 64, 0);
+            if (has_strings) {
+                std::vector<std::size_t> ends;
+                ends.reserve(rows);
+                for (const auto& cell : cells) {
+                    if (cell && std::holds_alternative<StringType>(*cell)) {
+                        a.chars += std::get<StringType>(*cell);
+                    } else if (cell) {
+                        append_double(a.chars, std::get<double>(*cell), false);
+                    }
+                    ends.push_back(a.chars.size());
+                }
+                // 64-bit offsets only when the text does not fit the 32-bit ones
+                bool large = a.chars.size() > static_cast<std::size_t>(std::numeric_limits<std::int32_t>::max());
+                child_schema->format = large ? "U" : "u";
+                if (large) {
+                    a.large_offsets.push_back(0);
+                    a.large_offsets.insert(a.large_offsets.end(), ends.begin(), ends.end());
+                } else {
+                    a.offsets.push_back(0);
+                    for (std::size_t end : ends) {
+                        a.offsets.push_back(static_cast<std::int32_t>(end));
+                    }
+                }
+            } else {
+                child_schema->format = "g";
+                a.values.assign(rows, 0.0);
+            }
+            for (std::size_t row = 0; row < rows; ++row) {
+                if (!cells[row]) {
+                    ++null_count;
+                    continue;
+                }
+                a.validity[row / 64] |= std::uint64_t{1} << (row % 64);
+                if (!has_strings) {
+                    a.values[row] = std::get<double>(*cells[row]);
+                }
+            }
 
-    // Identify rows with any `std::nullopt`
-    for (const auto& column : data) {
-        for (std::size_t i = 0; i < num_rows; ++i) {
-            if (!column[i].has_value()) {
-                rows_to_drop.push_back(i);
+            const void* validity = null_count > 0 ? a.validity.data() : nullptr;
+            if (!has_strings) {
+                a.buffers = {validity, a.values.data()};
+            } else if (a.offsets.empty()) {
+                a.buffers = {validity, a.large_offsets.data(), a.chars.data()};
+            } else {
+                a.buffers = {validity, a.offsets.data(), a.chars.data()};
             }
         }
-    }
 
-    // sort is necessary to rescale the index correctly
-    std::sort(rows_to_drop.begin(), rows_to_drop.end());
-    unsigned int cnt{0};
-    for (auto &&idx : rows_to_drop)
-    {
-        drop_row(idx-cnt);  // everytime a row is dropped, rescale the idx
-        cnt +=1;    
+        init_schema(&parent_schema->children[idx], child_schema.release(), ARROW_FLAG_NULLABLE);
+        init_array(&parent_array->children[idx], child_array.release(), static_cast<std::int64_t>(rows), null_count);
     }
+
+    init_schema(schema, parent_schema.release(), 0);
+    init_array(array, parent_array.release(), static_cast<std::int64_t>(rows), 0);
+    SCI_PROFILE_COUNT("rows", rows);
+    SCI_PROFILE_COUNT("shared_columns", shared_columns);
 }
 
-unsigned int DataFrame:: formatting_width() const
+void DataFrame::import_arrow(ArrowArray* array, ArrowSchema* schema)
 {
-    // Determine the maximum length of name for formatting the output
-    int max_name_len{0};
-    for (const auto& name : column_names) {
-        max_name_len = std::max(max_name_len, static_cast<int>(name.length()));
+    SCI_PROFILE_SCOPE("DataFrame::import_arrow");
+    // Take ownership, as the specification moves structures: copy them and mark
+    // the originals as released. The array is released when the last column
+    // reading its buffers is gone, the schema at the end of the import
+    if (array == nullptr || schema == nullptr || array->release == nullptr || schema->release == nullptr) {
+        throw std::invalid_argument("ERROR in function import_arrow(): the structures are missing or already released.");
     }
-    return max_name_len;
+    std::shared_ptr<ArrowArray> holder(new ArrowArray(*array), [](ArrowArray* a) {
+        if (a->release != nullptr) {
+            a->release(a);
+        }
+        delete a;
+    });
+    array->release = nullptr;
+    std::unique_ptr<ArrowSchema, void (*)(ArrowSchema*)> schema_holder(new ArrowSchema(*schema), [](ArrowSchema* s) {
+        if (s->release != nullptr) {
+            s->release(s);
+        }
+        delete s;
+    });
+    schema->release = nullptr;
+
+    const ArrowArray& parent = *holder;
+    const ArrowSchema& parent_schema = *schema_holder;
+    if (std::string(parent_schema.format) != "+s" || parent_schema.n_children != parent.n_children) {
+        throw std::invalid_argument("ERROR in function import_arrow(): a struct array (record batch) is expected.");
+    }
+
+    // Convert every child before touching the dataframe, so that a failure leaves it unchanged
+    const std::int64_t rows = parent.length;
+    auto pool = std::make_shared<std::pmr::monotonic_buffer_resource>();
+    std::vector<std::string> names;
+    std::vector<ColumnType> columns(parent.n_children);
+    std::vector<std::shared_ptr<const EncodedColumn>> views(parent.n_children);
+
+    for (std::int64_t k = 0; k < parent.n_children; ++k) {
+        const ArrowSchema& child_schema = *parent_schema.children[k];
+        const ArrowArray& child = *parent.children[k];
+        const std::string format = child_schema.format;
+        names.emplace_back(child_schema.name != nullptr ? child_schema.name : "Column_" + std::to_string(k));
+
+        if (child_schema.dictionary != nullptr || child.length < parent.offset + rows) {
+            throw std::invalid_argument("ERROR in function import_arrow(): unsupported layout for column " + names.back() + ".");
+        }
+        const std::int64_t begin = parent.offset + child.offset;
+        const void* validity = child.null_count == 0 ? nullptr : child.buffers[0];
+
+        if (format == "g" && reinterpret_cast<std::uintptr_t>(static_cast<const double*>(child.buffers[1]) + begin) % alignof(double) == 0) {
+            // read the values in place
+            views[k] = std::make_shared<const EncodedColumn>(EncodedColumn::plain_view(
+                static_cast<const double*>(child.buffers[1]) + begin, static_cast<std::size_t>(rows), copy_validity(validity, begin, rows), holder));
+            continue;
+        }
+
+        ColumnType& column = columns[k];
+        column.reserve(static_cast<std::size_t>(rows));
+        if (format.size() == 1 && std::string("gfcCsSiIlL").find(format[0]) != std::string::npos) {
+            for (std::int64_t row = begin; row < begin + rows; ++row) {
+                if (arrow_is_valid(validity, row)) {
+                    column.emplace_back(arrow_number(format.c_str(), child.buffers[1], row));
+                } else {
+                    column.emplace_back(std::nullopt);
+                }
+            }
+        } else if (format == "u" || format == "U") {
+            const char* chars = static_cast<const char*>(child.buffers[2]);
+            for (std::int64_t row = begin; row < begin + rows; ++row) {
+                if (!arrow_is_valid(validity, row)) {
+                    column.emplace_back(std::nullopt);
+                    continue;
+                }
+                std::int64_t first = format == "u" ? static_cast<const std::int32_t*>(child.buffers[1])[row]
+                                                   : static_cast<const std::int64_t*>(child.buffers[1])[row];
+                std::int64_t last = format == "u" ? static_cast<const std::int32_t*>(child.buffers[1])[row + 1]
+                                                  : static_cast<const std::int64_t*>(child.buffers[1])[row + 1];
+                std::string_view text(chars + first, static_cast<std::size_t>(last - first));
+                if (text.empty()) {
+                    column.emplace_back(std::nullopt);     // as read_csv, empty means missing
+                } else {
+                    column.emplace_back(std::in_place, std::in_place_type<StringType>, text, pool.get());
+                }
+            }
+        } else {
+            throw std::invalid_argument("ERROR in function import_arrow(): unsupported format " + format + " for column " + names.back() + ".");
+        }
+    }
+
+    // the buffers keep the new arena, the old one goes with the last buffer using it
+    column_names = std::move(names);
+    string_pool = std::move(pool);
+    data.clear();
+    for (auto& column : columns) {
+        data.push_back(share_column(std::move(column)));
+    }
+    encoded = std::move(views);
+    build_index();
+    SCI_PROFILE_COUNT("rows", rows);
 }
 
 /* -------------------------------------------------------------------------- */
@@ -372,8 +1454,17 @@ unsigned int DataFrame:: formatting_width() const
 /* -------------------------------------------------------------------------- */
 
 double DataFrame::mean(const std::string& name) const {
+    return mean(get_handle(name));
+}
+
+double DataFrame::mean(ColumnHandle column) const {
+    // Encoded columns are summarised without decoding them
+    if (encoded[column.index] && encoded[column.index]->count() > 0) {
+        return encoded[column.index]->sum() / encoded[column.index]->count();
+    }
+
     // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values= get_double_column(name);
+    std::vector<double> values= get_double_column(column);
     if (values.empty()) {
         throw std::runtime_error("ERROR in function mean(): vector is empty.");
     }
@@ -382,8 +1473,12 @@ double DataFrame::mean(const std::string& name) const {
 }
 
 double DataFrame::median(const std::string& name) const {
+    return median(get_handle(name));
+}
+
+double DataFrame::median(ColumnHandle column) const {
     // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values= get_double_column(name);
+    std::vector<double> values= get_double_column(column);
 
     if (values.empty()) {
         throw std::runtime_error("ERROR in function median(): vector is empty.");
@@ -393,8 +1488,17 @@ double DataFrame::median(const std::string& name) const {
 }
 
 double DataFrame::min(const std::string& name) const {
+    return min(get_handle(name));
+}
+
+double DataFrame::min(ColumnHandle column) const {
+    // Encoded columns are summarised without decoding them
+    if (encoded[column.index] && encoded[column.index]->count() > 0) {
+        return encoded[column.index]->min();
+    }
+
     // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values= get_double_column(name);
+    std::vector<double> values= get_double_column(column);
 
     if (values.empty()) {
         throw std::runtime_error("ERROR in function min(): vector is empty.");
@@ -404,8 +1508,17 @@ double DataFrame::min(const std::string& name) const {
 }
 
 double DataFrame::max(const std::string& name) const {
+    return max(get_handle(name));
+}
+
+double DataFrame::max(ColumnHandle column) const {
+    // Encoded columns are summarised without decoding them
+    if (encoded[column.index] && encoded[column.index]->count() > 0) {
+        return encoded[column.index]->max();
+    }
+
     // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values= get_double_column(name);
+    std::vector<double> values= get_double_column(column);
 
     if (values.empty()) {
         throw std::runtime_error("ERROR in function max(): vector is empty.");
@@ -415,8 +1528,12 @@ double DataFrame::max(const std::string& name) const {
 }
 
 double DataFrame::quantile(const std::string& name, const double& q) const {
+    return quantile(get_handle(name), q);
+}
+
+double DataFrame::quantile(ColumnHandle column, const double& q) const {
     // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values= get_double_column(name);
+    std::vector<double> values= get_double_column(column);
 
     if (values.empty()) {
         throw std::runtime_error("ERROR in function quantile(): vector is empty.");
@@ -427,8 +1544,12 @@ double DataFrame::quantile(const std::string& name, const double& q) const {
 }
 
 double DataFrame::var(const std::string& name) const {
+    return var(get_handle(name));
+}
+
+double DataFrame::var(ColumnHandle column) const {
     // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values= get_double_column(name);
+    std::vector<double> values= get_double_column(column);
 
     if (values.empty()) {
         throw std::runtime_error("ERROR in function var(): vector is empty.");
@@ -438,8 +1559,12 @@ double DataFrame::var(const std::string& name) const {
 }
 
 double DataFrame::sd(const std::string& name) const {
+    return sd(get_handle(name));
+}
+
+double DataFrame::sd(ColumnHandle column) const {
     // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values= get_double_column(name);
+    std::vector<double> values= get_double_column(column);
 
     if (values.empty()) {
         throw std::runtime_error("ERROR in function sd(): vector is empty.");
@@ -448,67 +1573,429 @@ double DataFrame::sd(const std::string& name) const {
     return gsl_stats_sd(values.data(), 1, values.size());
 }
 
-double DataFrame::covariance(const std::string& name1, const std::string& name2) const {
-    // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values1= get_double_column(name1);
-    std::vector<double> values2= get_double_column(name2);
+// co-moments of two columns over the rows where both are valid, in one pass
+struct CoMoments {
+    std::size_t count{0};
+    double sxx{0.0};    // sums of the squared deviations from the means
+    double syy{0.0};
+    double sxy{0.0};    // sum of the products of the deviations
+};
+
+// The sums are shifted by the first complete pair, so that they do not cancel
+// out when the values are far from zero. The loop has no branch (the nulls
+// are masked by a select on the weights, not by a product, so that a NaN or
+// an infinity on a row without its pair does not leak into the sums) and
+// keeps four independent sums of each kind, which the compiler can keep in
+// vector registers.
+static CoMoments co_moments(const std::vector<double>& x, const std::vector<double>& wx,
+                            const std::vector<double>& y, const std::vector<double>& wy)
+{
+    const std::size_t n = x.size();
+    std::size_t first{0};
+    while (first < n && wx[first] * wy[first] == 0.0) {
+        ++first;
+    }
+    CoMoments m;
+    if (first == n) {
+        return m;
+    }
+    const double kx = x[first];
+    const double ky = y[first];
+
+    constexpr std::size_t lanes = 4;
+    double sw[lanes]{}, sx[lanes]{}, sy[lanes]{}, sxx[lanes]{}, syy[lanes]{}, sxy[lanes]{};
+    auto accumulate = [&](std::size_t lane, std::size_t i) {
+        double w = wx[i] * wy[i];
+        double dx = w != 0.0 ? x[i] - kx : 0.0;
+        double dy = w != 0.0 ? y[i] - ky : 0.0;
+        sw[lane] += w;
+        sx[lane] += dx;
+        sy[lane] += dy;
+        sxx[lane] += dx * dx;
+        syy[lane] += dy * dy;
+        sxy[lane] += dx * dy;
+    };
+    std::size_t i = first;
+    for (; i + lanes <= n; i += lanes) {
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            accumulate(lane, i + lane);
+        }
+    }
+    for (; i < n; ++i) {
+        accumulate(0, i);
+    }
+    for (std::size_t lane = 1; lane < lanes; ++lane) {
+        sw[0] += sw[lane];
+        sx[0] += sx[lane];
+        sy[0] += sy[lane];
+        sxx[0] += sxx[lane];
+        syy[0] += syy[lane];
+        sxy[0] += sxy[lane];
+    }
+
+    m.count = static_cast<std::size_t>(sw[0]);
+    m.sxx = std::max(sxx[0] - sx[0] * sx[0] / sw[0], 0.0);
+    m.syy = std::max(syy[0] - sy[0] * sy[0] / sw[0], 0.0);
+    m.sxy = sxy[0] - sx[0] * sy[0] / sw[0];
+    return m;
+}
+
+// sample covariance, as gsl_stats_covariance
+static double covariance_of(const CoMoments& m)
+{
+    return m.sxy / (m.count - 1);
+}
+
+// Pearson correlation, kept in [-1, 1] despite the rounding
+static double correlation_of(const CoMoments& m)
+{
+    return std::clamp(m.sxy / std::sqrt(m.sxx * m.syy), -1.0, 1.0);
+}
 
-    if (values1.empty()||values2.empty()) {
-        throw std::runtime_error("ERROR in function covariance(): one of the two vectors is empty");
+void DataFrame::dense_values(std::size_t idx, const std::string& function, std::vector<double>& values, std::vector<double>& weights) const
+{
+    ColumnType decoded;
+    if (encoded[idx]) {
+        decoded = encoded[idx]->decode();
+    }
+    const ColumnType& cells = encoded[idx] ? decoded : *data[idx];
+
+    values.assign(cells.size(), 0.0);
+    weights.assign(cells.size(), 0.0);
+    for (std::size_t row = 0; row < cells.size(); ++row) {
+        const auto& cell = cells[row];
+        if (!cell) {
+            continue;
+        }
+        if (!std::holds_alternative<double>(*cell)) {
+            throw std::invalid_argument("ERROR in function " + function + "(): column " + column_names[idx] + " is not numeric.");
+        }
+        values[row] = std::get<double>(*cell);
+        weights[row] = 1.0;
     }
-    // If sizes don't match, raise an error
-    if (values1.size() != values2.size()) {
-        throw std::runtime_error("ERROR in function covariance(): incompatible sizes to compute covariance.");
+}
+
+double DataFrame::covariance(const std::string& name1, const std::string& name2) const {
+    SCI_PROFILE_SCOPE("DataFrame::covariance");
+    // one pass over the rows where both values are valid, the columns stay aligned
+    std::vector<double> x, wx, y, wy;
+    dense_values(find_idx(name1), "covariance", x, wx);
+    dense_values(find_idx(name2), "covariance", y, wy);
+    CoMoments m = co_moments(x, wx, y, wy);
+    SCI_PROFILE_COUNT("rows", m.count);
+
+    if (m.count < 2) {
+        throw std::runtime_error("ERROR in function covariance(): at least two rows with both values are needed.");
     }
-    // If everything is ok, return the covariance
-    return gsl_stats_covariance(values1.data(), 1, values2.data(),1,values1.size());
+    return covariance_of(m);
 }
 
 double DataFrame::correlation(const std::string& name1, const std::string& name2) const {
-    // Convert the column into a std::vector of doubles in order to use the gls method
-    std::vector<double> values1= get_double_column(name1);
-    std::vector<double> values2= get_double_column(name2);
+    SCI_PROFILE_SCOPE("DataFrame::correlation");
+    std::vector<double> x, wx, y, wy;
+    dense_values(find_idx(name1), "correlation", x, wx);
+    dense_values(find_idx(name2), "correlation", y, wy);
+    CoMoments m = co_moments(x, wx, y, wy);
+    SCI_PROFILE_COUNT("rows", m.count);
+
+    if (m.count < 2) {
+        throw std::runtime_error("ERROR in function correlation(): at least two rows with both values are needed.");
+    }
+    return correlation_of(m);
+}
+
+std::size_t DataFrame::pairwise_count(const std::string& name1, const std::string& name2) const
+{
+    std::vector<double> x, wx, y, wy;
+    dense_values(find_idx(name1), "pairwise_count", x, wx);
+    dense_values(find_idx(name2), "pairwise_count", y, wy);
+    std::size_t count{0};
+    for (std::size_t row = 0; row < wx.size(); ++row) {
+        count += static_cast<std::size_t>(wx[row] * wy[row]);
+    }
+    return count;
+}
+
+PairwiseMatrix DataFrame::pairwise(const std::vector<std::string>& names, bool correlation, const std::string& function) const
+{
+    const std::size_t k = names.size();
+    std::vector<std::vector<double>> values(k), weights(k);
+    for (std::size_t col = 0; col < k; ++col) {
+        dense_values(find_idx(names[col]), function, values[col], weights[col]);
+    }
+
+    PairwiseMatrix result;
+    result.names = names;
+    result.values.assign(k, std::vector<double>(k, std::nan("")));
+    result.counts.assign(k, std::vector<std::size_t>(k, 0));
+
+    // the pairs (i, j) with i <= j, spread over the threads
+    std::vector<std::pair<std::size_t, std::size_t>> pairs;
+    for (std::size_t i = 0; i < k; ++i) {
+        for (std::size_t j = i; j < k; ++j) {
+            pairs.emplace_back(i, j);
+        }
+    }
+    parallel::for_chunks(pairs.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t p = begin; p < end; ++p) {
+            auto [i, j] = pairs[p];
+            CoMoments m = co_moments(values[i], weights[i], values[j], weights[j]);
+            result.counts[i][j] = result.counts[j][i] = m.count;
+            if (m.count >= 2) {
+                result.values[i][j] = result.values[j][i] = correlation ? correlation_of(m) : covariance_of(m);
+            }
+        }
+    });
+    return result;
+}
+
+PairwiseMatrix DataFrame::pairwise_covariance(const std::vector<std::string>& names) const
+{
+    SCI_PROFILE_SCOPE("DataFrame::pairwise_covariance");
+    return pairwise(names, false, "pairwise_covariance");
+}
+
+PairwiseMatrix DataFrame::pairwise_correlation(const std::vector<std::string>& names) const
+{
+    SCI_PROFILE_SCOPE("DataFrame::pairwise_correlation");
+    return pairwise(names, true, "pairwise_correlation");
+}
+
+// SplitMix64 finaliser: a bijective mix of the 64 bits of a counter
+static std::uint64_t mix64(std::uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Counter-based random indices: the i-th draw of a stream is a pure function of
+// (seed, stream, i), so any thread can generate any resample
+class IndexStream {
+public:
+    IndexStream(std::uint64_t seed, std::uint64_t stream)
+        : key(mix64(seed ^ mix64(stream + golden))) {}
+
+    // i-th index in [0, n), n < 2^32 (multiply-shift, no division)
+    std::size_t index(std::uint64_t i, std::uint64_t n) const
+    {
+        return static_cast<std::size_t>(((mix64(key + (i + 1) * golden) >> 32) * n) >> 32);
+    }
+
+private:
+    static constexpr std::uint64_t golden{0x9e3779b97f4a7c15ULL};
+    std::uint64_t key;
+};
+
+std::vector<std::optional<double>> DataFrame::optional_values(std::size_t idx, const std::string& function) const
+{
+    ColumnType decoded;
+    if (encoded[idx]) {
+        decoded = encoded[idx]->decode();
+    }
+    const ColumnType& cells = encoded[idx] ? decoded : *data[idx];
+
+    std::vector<std::optional<double>> values;
+    values.reserve(cells.size());
+    for (const auto& cell : cells) {
+        // the cells parsed from "nan" are missing values as well
+        if (!cell || (std::holds_alternative<double>(*cell) && std::isnan(std::get<double>(*cell)))) {
+            values.emplace_back(std::nullopt);
+        } else if (std::holds_alternative<double>(*cell)) {
+            values.emplace_back(std::get<double>(*cell));
+        } else {
+            throw std::invalid_argument("ERROR in function " + function + "(): column " + column_names[idx] + " is not numeric.");
+        }
+    }
+    return values;
+}
+
+Rolling DataFrame::rolling(const std::string& name, std::size_t window, std::size_t min_periods) const
+{
+    return Rolling(optional_values(find_idx(name), "rolling"), window, min_periods);
+}
+
+Rolling DataFrame::rolling(const std::string& name, double duration, const std::string& on, std::size_t min_periods) const
+{
+    std::vector<double> times;
+    for (const auto& time : optional_values(find_idx(on), "rolling")) {
+        if (!time) {
+            throw std::invalid_argument("ERROR in function rolling(): the column " + on + " has missing values.");
+        }
+        times.push_back(*time);
+    }
+    return Rolling(optional_values(find_idx(name), "rolling"), times, duration, min_periods);
+}
+
+std::vector<double> DataFrame::bootstrap(Statistic stat, const std::vector<std::string>& columns, std::size_t n_resamples, std::uint64_t seed) const
+{
+    SCI_PROFILE_SCOPE("DataFrame::bootstrap");
+    const std::size_t n_columns = stat == Statistic::Correlation ? 2 : 1;
+    if (columns.size() != n_columns) {
+        throw std::invalid_argument("ERROR in function bootstrap(): the statistic needs " + std::to_string(n_columns) + " column(s).");
+    }
+
+    // the samples to resample: the valid values, or the valid pairs of values
+    std::vector<double> x, y;
+    if (stat == Statistic::Correlation) {
+        std::vector<std::size_t> idx{find_idx(columns[0]), find_idx(columns[1])};
+        std::vector<ColumnType> decoded(2);
+        std::vector<const ColumnType*> cells(2);
+        for (std::size_t k = 0; k < 2; ++k) {
+            if (encoded[idx[k]]) {
+                decoded[k] = encoded[idx[k]]->decode();
+            }
+            cells[k] = encoded[idx[k]] ? &decoded[k] : data[idx[k]].get();
+        }
+        for (std::size_t row = 0; row < cells[0]->size(); ++row) {
+            const auto& a = (*cells[0])[row];
+            const auto& b = (*cells[1])[row];
+            if (a && b && std::holds_alternative<double>(*a) && std::holds_alternative<double>(*b) &&
+                !std::isnan(std::get<double>(*a)) && !std::isnan(std::get<double>(*b))) {
+                x.push_back(std::get<double>(*a));
+                y.push_back(std::get<double>(*b));
+            }
+        }
+    } else {
+        // the cells parsed from "nan" are missing values as well: they would
+        // break the ordering of the values ranked for the median
+        x = get_double_column(columns[0]);
+        x.erase(std::remove_if(x.begin(), x.end(), [](double v) { return std::isnan(v); }), x.end());
+    }
+
+    const std::size_t n = x.size();
+    if (n < n_columns) {
+        throw std::runtime_error("ERROR in function bootstrap(): not enough valid values.");
+    }
+    if (n >= (std::uint64_t{1} << 32)) {
+        throw std::invalid_argument("ERROR in function bootstrap(): too many rows to resample.");
+    }
+    SCI_PROFILE_COUNT("rows", n);
+    SCI_PROFILE_COUNT("resamples", n_resamples);
+
+    // Nothing is gathered: a resample is a multiset of row indices, so the
+    // statistics are accumulated directly from the drawn rows
+    std::vector<double> results(n_resamples);
+    switch (stat) {
+    case Statistic::Mean:
+        parallel::for_chunks(n_resamples, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r) {
+                IndexStream stream(seed, r);
+                double sum{0.0};
+                for (std::size_t i = 0; i < n; ++i) {
+                    sum += x[stream.index(i, n)];
+                }
+                results[r] = sum / n;
+            }
+        });
+        break;
+
+    case Statistic::Median: {
+        // count how many times each value is drawn, then walk the sorted values
+        // up to the middle rank: linear, and no partial sort per resample
+        std::vector<std::size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&x](std::size_t a, std::size_t b) { return x[a] < x[b]; });
+        std::vector<double> sorted(n);
+        std::vector<std::uint32_t> rank(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            sorted[k] = x[order[k]];
+            rank[order[k]] = static_cast<std::uint32_t>(k);
+        }
+
+        parallel::for_chunks(n_resamples, 1, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::uint32_t> counts(n);
+            for (std::size_t r = begin; r < end; ++r) {
+                IndexStream stream(seed, r);
+                std::fill(counts.begin(), counts.end(), 0);
+                for (std::size_t i = 0; i < n; ++i) {
+                    ++counts[rank[stream.index(i, n)]];
+                }
+                // values of rank (n-1)/2 and n/2 in the resample
+                std::size_t low_rank = (n - 1) / 2, seen{0}, k{0};
+                while (seen + counts[k] <= low_rank) {
+                    seen += counts[k++];
+                }
+                double low = sorted[k];
+                while (seen + counts[k] <= n / 2) {
+                    seen += counts[k++];
+                }
+                results[r] = (low + sorted[k]) / 2;
+            }
+        });
+        break;
+    }
+
+    case Statistic::Correlation: {
+        // shift the samples by their means to keep the sums of products accurate
+        double mean_x = gsl_stats_mean(x.data(), 1, n);
+        double mean_y = gsl_stats_mean(y.data(), 1, n);
+        for (std::size_t i = 0; i < n; ++i) {
+            x[i] -= mean_x;
+            y[i] -= mean_y;
+        }
 
-    if (values1.empty()||values2.empty()) {
-        throw std::runtime_error("ERROR in function correlation(): vector is empty.");
+        parallel::for_chunks(n_resamples, 1, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t r = begin; r < end; ++r) {
+                IndexStream stream(seed, r);
+                double sx{0.0}, sy{0.0}, sxx{0.0}, syy{0.0}, sxy{0.0};
+                for (std::size_t i = 0; i < n; ++i) {
+                    std::size_t pick = stream.index(i, n);
+                    sx += x[pick];
+                    sy += y[pick];
+                    sxx += x[pick] * x[pick];
+                    syy += y[pick] * y[pick];
+                    sxy += x[pick] * y[pick];
+                }
+                double cxx = sxx - sx * sx / n;
+                double cyy = syy - sy * sy / n;
+                double cxy = sxy - sx * sy / n;
+                results[r] = cxy / std::sqrt(cxx * cyy);
+            }
+        });
+        break;
     }
-    // If vectors have different sizes raise an error
-    if (values1.size() != values2.size()) {
-        throw std::runtime_error("ERROR in function correlation(): incompatible sizes to compute covariance.");
     }
-    // If everything is ok, return the covariance
-    return gsl_stats_correlation(values1.data(), 1, values2.data(),1,values1.size());
+    return results;
 }
 
 void DataFrame::correlation_matrix(std::vector<std::string>& names) const {
+    SCI_PROFILE_SCOPE("DataFrame::correlation_matrix");
     // Determine the maximum length of a numeric name for formatting
     unsigned int max_name_len{formatting_width() +3};
 
-    // Print the header row with appropriate spacing
+    // Keep only the numeric attributes, checking each of them once
+    std::vector<std::string> numeric_names;
     for (const auto& name : names) {
         if (is_numeric(name)) {
-            std::cout << std::setw(max_name_len) << std::right << name;
+            numeric_names.push_back(name);
         }
     }
+
+    // Print the header row with appropriate spacing
+    for (const auto& name : numeric_names) {
+        std::cout << std::setw(max_name_len) << std::right << name;
+    }
     std::cout << std::endl;
 
-    // Print the correlation matrix with formatted output
-    for (const auto& name1 : names) {
-        if (is_numeric(name1)) {
-            for (const auto& name2 : names) {
-                if (is_numeric(name2)) {
-                    std::cout << std::fixed << std::setprecision(4) << std::setw(max_name_len) << correlation(name1, name2);
-                }
-            }
-            std::cout << std::endl;
+    // Print the correlation matrix with formatted output, each column being
+    // converted once for all the pairs
+    PairwiseMatrix matrix = pairwise_correlation(numeric_names);
+    for (const auto& row : matrix.values) {
+        for (double value : row) {
+            std::cout << std::fixed << std::setprecision(4) << std::setw(max_name_len) << value;
         }
+        std::cout << std::endl;
     }
 }
 
 void DataFrame::table(const std::string& name) const {
-    std::map<std::string,unsigned int> table{};
-    for (auto& val : get_string_column(name)) {
-        table[val] ++; // Update the frequency
+    // count directly on the cells, the keys are views on the stored strings
+    std::map<std::string_view,unsigned int> table{};
+    for (const auto& cell : *data[find_idx(name)]) {
+        if (cell && std::holds_alternative<StringType>(*cell)) {
+            table[std::get<StringType>(*cell)] ++; // Update the frequency
+        }
     }
     unsigned int spacing{formatting_width() +3};
     // print attributes
@@ -556,8 +2043,8 @@ void DataFrame::head() const
                 if (std::holds_alternative<double>(value)) {
                     std::cout << std::setw(spacing)<< std::get<double>(value);
                 }
-                else if (std::holds_alternative<std::string>(value)) {
-                    std::cout << std::setw(spacing)<< std::get<std::string>(value);
+                else if (std::holds_alternative<StringType>(value)) {
+                    std::cout << std::setw(spacing)<< std::get<StringType>(value);
                 }
             } 
             else 
@@ -610,19 +2097,22 @@ void DataFrame::histogram(const std::string& name, int num_bins) const
 }
 
 void DataFrame::summary() const {
+    AllocationTracker::Scope tracked("summary");
+    SCI_PROFILE_SCOPE("DataFrame::summary");
     const unsigned int spacing{formatting_width() + 3};
 
-    // Calculate the total width of the table
-    unsigned int n_numeric_feat{};
-    for (auto &&col : column_names)
+    // Collect the numerical attributes once, every row of the table reuses them
+    std::vector<ColumnHandle> numeric;
+    for (std::size_t idx = 0; idx < column_names.size(); ++idx)
     {   
-        if (is_numeric(col))
+        if (is_numeric(ColumnHandle{idx}))
         {
-            n_numeric_feat++;
+            numeric.push_back(ColumnHandle{idx});
         }     
     }
 
-    unsigned int total_width = spacing * n_numeric_feat + 10;
+    // Calculate the total width of the table
+    unsigned int total_width = spacing * numeric.size() + 10;
 
     // Create the header string, centered within the total width
     std::string header_str = " Dataset Summary ";
@@ -633,64 +2123,50 @@ void DataFrame::summary() const {
 
     // Headers for each column
     std::cout << std::setw(10) << "";
-    for (const auto& name : column_names) {
-        if (is_numeric(name)) {
-            std::cout << std::setw(spacing) << std::left << name;
-        }
+    for (const auto& column : numeric) {
+        std::cout << std::setw(spacing) << std::left << column_names[column.index];
     }
     std::cout << std::endl;
 
     // Print Min
     std::cout << std::setw(10) << "Min.";
-    for (const auto& name : column_names) {
-        if (is_numeric(name)) {
-            std::cout << std::setw(spacing) << min(name);
-        }
+    for (const auto& column : numeric) {
+        std::cout << std::setw(spacing) << min(column);
     }
     std::cout << std::endl;
 
     // Print 1st Quartile
     std::cout << std::setw(10) << "1st Qu.";
-    for (const auto& name : column_names) {
-        if (is_numeric(name)) {
-            std::cout << std::setw(spacing) << quantile(name, 0.25);
-        }
+    for (const auto& column : numeric) {
+        std::cout << std::setw(spacing) << quantile(column, 0.25);
     }
     std::cout << std::endl;
 
     // Print Median
     std::cout << std::setw(10) << "Median";
-    for (const auto& name : column_names) {
-        if (is_numeric(name)) {
-            std::cout << std::setw(spacing) << median(name);
-        }
+    for (const auto& column : numeric) {
+        std::cout << std::setw(spacing) << median(column);
     }
     std::cout << std::endl;
 
     // Print Mean
     std::cout << std::setw(10) << "Mean";
-    for (const auto& name : column_names) {
-        if (is_numeric(name)) {
-            std::cout << std::setw(spacing) << mean(name);
-        }
+    for (const auto& column : numeric) {
+        std::cout << std::setw(spacing) << mean(column);
     }
     std::cout << std::endl;
 
     // Print 3rd Quartile
     std::cout << std::setw(10) << "3rd Qu.";
-    for (const auto& name : column_names) {
-        if (is_numeric(name)) {
-            std::cout << std::setw(spacing) << quantile(name, 0.75);
-        }
+    for (const auto& column : numeric) {
+        std::cout << std::setw(spacing) << quantile(column, 0.75);
     }
     std::cout << std::endl;
 
     // Print Max
     std::cout << std::setw(10) << "Max.";
-    for (const auto& name : column_names) {
-        if (is_numeric(name)) {
-            std::cout << std::setw(spacing) << max(name);
-        }
+    for (const auto& column : numeric) {
+        std::cout << std::setw(spacing) << max(column);
     }
     std::cout << std::endl;
     std::cout << std::string(total_width, '-') << std::endl; 
@@ -706,8 +2182,9 @@ DataFrame::row_iterator::row_iterator(const DataFrame& df, size_t row)
     : dataframe(df), current_row(row) {
     // maximum rows number is the size of the shortest column
     max_rows = std::numeric_limits<size_t>::max();
-    for (const auto& column : dataframe.data) {
-        max_rows = std::min(max_rows, column.size());
+    for (size_t col = 0; col < dataframe.data.size(); ++col) {
+        const auto& encoded = dataframe.encoded[col];
+        max_rows = std::min(max_rows, encoded ? encoded->size() : dataframe.data[col]->size());
     }
 }
 
@@ -715,9 +2192,18 @@ DataFrame::row_iterator::value_type DataFrame::row_iterator::operator*() const {
     value_type row;
 
     // fill the row by scanning all the columns for a fixed idex 
-    for (const auto& column : dataframe.data) {
-        if (current_row < column.size()) {
-            row.push_back(column[current_row]);
+    for (size_t col = 0; col < dataframe.data.size(); ++col) {
+        const auto& encoded = dataframe.encoded[col];
+        if (encoded && current_row < encoded->size()) {
+            auto value = encoded->at(current_row);
+            if (value) {
+                row.emplace_back(*value);
+            } else {
+                row.emplace_back(std::nullopt);
+            }
+        }
+        else if (current_row < dataframe.data[col]->size()) {
+            row.push_back((*dataframe.data[col])[current_row]);
         }
     }
     return row;
@@ -761,8 +2247,8 @@ DataFrame::row_iterator DataFrame::begin() const {
 DataFrame::row_iterator DataFrame::end() const { 
     // maximum rows number is the size of the shortest column
     size_t max_rows = std::numeric_limits<size_t>::max();
-    for (const auto& column : data) {
-        max_rows = std::min(max_rows, column.size());
+    for (size_t col = 0; col < data.size(); ++col) {
+        max_rows = std::min(max_rows, encoded[col] ? encoded[col]->size() : data[col]->size());
     }
     return row_iterator(*this, max_rows); 
 }
@@ -0,0 +1,375 @@
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+#include "Dataset.hpp"
+#include "Parallel.hpp"
+#include "Profiler.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// read-only stream buffer over characters already in memory, so that the
+// readers parse a loaded file without copying it
+class MemoryBuffer : public std::streambuf {
+public:
+    explicit MemoryBuffer(const std::string& content)
+    {
+        char* begin = const_cast<char*>(content.data());
+        setg(begin, begin, begin + content.size());
+    }
+};
+
+bool has_wildcard(const std::string& component)
+{
+    return component.find_first_of("*?") != std::string::npos;
+}
+
+// match a single path component against a pattern with `*` and `?`
+bool match_component(const char* pattern, const char* name)
+{
+    // backtrack only to the last star: linear in practice
+    const char* star{nullptr};
+    const char* resume{nullptr};
+    while (*name != '\0') {
+        if (*pattern == '*') {
+            star = pattern++;
+            resume = name;
+        } else if (*pattern == '?' || *pattern == *name) {
+            ++pattern;
+            ++name;
+        } else if (star != nullptr) {
+            pattern = star + 1;
+            name = ++resume;
+        } else {
+            return false;
+        }
+    }
+    while (*pattern == '*') {
+        ++pattern;
+    }
+    return *pattern == '\0';
+}
+
+// match the components of a relative path, `**` standing for any number of directories
+bool match_path(const std::vector<std::string>& pattern, std::size_t p,
+                const std::vector<std::string>& path, std::size_t k)
+{
+    if (p == pattern.size()) {
+        return k == path.size();
+    }
+    if (pattern[p] == "**") {
+        return match_path(pattern, p + 1, path, k) || (k < path.size() && match_path(pattern, p, path, k + 1));
+    }
+    return k < path.size() && match_component(pattern[p].c_str(), path[k].c_str()) && match_path(pattern, p + 1, path, k + 1);
+}
+
+// %XX escapes are used in the partition values for the characters not allowed in paths
+std::string percent_decode(const std::string& s)
+{
+    std::string out;
+    out.reserve(s.size());
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        unsigned int code{0};
+        if (s[i] == '%' && i + 2 < s.size() &&
+            std::from_chars(s.data() + i + 1, s.data() + i + 3, code, 16).ptr == s.data() + i + 3) {
+            out += static_cast<char>(code);
+            i += 2;
+        } else {
+            out += s[i];
+        }
+    }
+    return out;
+}
+
+// true if the whole value is a number
+bool is_number(const std::string& value, double& number)
+{
+    const char* end = value.data() + value.size();
+    return !value.empty() && std::from_chars(value.data(), end, number).ptr == end;
+}
+
+std::string load_file(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("could not open the file");
+    }
+    std::string content(static_cast<std::size_t>(fs::file_size(path)), '\0');
+    file.read(content.data(), static_cast<std::streamsize>(content.size()));
+    content.resize(static_cast<std::size_t>(file.gcount()));
+    return content;
+}
+
+} // namespace
+
+Dataset::Dataset(const std::string& path, char separator)
+    : separator(separator)
+{
+    // the leading components without wildcards are the directory to search
+    fs::path root;
+    std::vector<std::string> pattern;
+    for (const auto& component : fs::path(path)) {
+        if (pattern.empty() && !has_wildcard(component.string()) && component != "**") {
+            root /= component;
+        } else {
+            pattern.push_back(component.string());
+        }
+    }
+    // a single file is a dataset as well
+    if (pattern.empty() && fs::is_regular_file(root)) {
+        pattern.push_back(root.filename().string());
+        root = root.parent_path();
+    }
+    if (root.empty()) {
+        root = ".";
+    }
+    if (!fs::is_directory(root)) {
+        throw std::invalid_argument("ERROR in function Dataset(): directory not found: " + root.string());
+    }
+    // a directory alone stands for all its files
+    if (pattern.empty()) {
+        pattern = {"**", "*"};
+    }
+    bool recursive = std::find(pattern.begin(), pattern.end(), "**") != pattern.end();
+
+    std::vector<std::string> components;
+    for (auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied);
+         it != fs::recursive_directory_iterator(); ++it) {
+        // without ** the pattern tells how deep the files are
+        if (!recursive && it->is_directory() && static_cast<std::size_t>(it.depth()) + 2 > pattern.size()) {
+            it.disable_recursion_pending();
+        }
+        if (!it->is_regular_file()) {
+            continue;
+        }
+        // the compressed files are recognised by the readers, the extension before tells the format
+        fs::path name = it->path().filename();
+        if (name.extension() == ".gz" || name.extension() == ".zst") {
+            name = name.stem();
+        }
+        std::string extension = name.extension().string();
+        if (extension != ".csv" && extension != ".json") {
+            continue;
+        }
+        components.clear();
+        for (const auto& component : it->path().lexically_relative(root)) {
+            components.push_back(component.string());
+        }
+        if (!match_path(pattern, 0, components, 0)) {
+            continue;
+        }
+
+        File file{it->path().string(), extension == ".csv" ? Format::Csv : Format::Json, {}};
+        for (const auto& component : it->path().parent_path()) {
+            std::string name = component.string();
+            std::size_t equal = name.find('=');
+            if (equal != std::string::npos && equal > 0) {
+                file.partitions.emplace_back(name.substr(0, equal), percent_decode(name.substr(equal + 1)));
+            }
+        }
+        selected.push_back(std::move(file));
+    }
+    std::sort(selected.begin(), selected.end(), [](const File& a, const File& b) { return a.path < b.path; });
+}
+
+std::vector<std::string> Dataset::files() const
+{
+    std::vector<std::string> paths;
+    paths.reserve(selected.size());
+    for (const auto& file : selected) {
+        paths.push_back(file.path);
+    }
+    return paths;
+}
+
+std::vector<std::string> Dataset::partition_keys() const
+{
+    std::vector<std::string> keys;
+    for (const auto& file : selected) {
+        for (const auto& [key, value] : file.partitions) {
+            if (std::find(keys.begin(), keys.end(), key) == keys.end()) {
+                keys.push_back(key);
+            }
+        }
+    }
+    return keys;
+}
+
+Dataset& Dataset::filter(const std::string& key, const std::function<bool(const std::string&)>& keep)
+{
+    auto dropped = [&](const File& file) {
+        // the innermost directory wins if a key is repeated along the path
+        for (auto it = file.partitions.rbegin(); it != file.partitions.rend(); ++it) {
+            if (it->first == key) {
+                return !keep(it->second);
+            }
+        }
+        return true;
+    };
+    selected.erase(std::remove_if(selected.begin(), selected.end(), dropped), selected.end());
+    return *this;
+}
+
+Dataset& Dataset::filter(const std::string& key, const std::string& value)
+{
+    return filter(key, [&value](const std::string& v) { return v == value; });
+}
+
+DataFrame Dataset::parse(const File& file, const std::string& content, const std::set<std::string>& numeric_keys) const
+{
+    MemoryBuffer buffer(content);
+    std::istream input(&buffer);
+    DataFrame frame;
+    if (file.format == Format::Csv) {
+        frame.read_csv(input, separator);
+    } else {
+        frame.read_json(input);
+    }
+
+    const std::size_t rows = frame.shape().first;
+    const auto& header = frame.get_header();
+    for (auto it = file.partitions.begin(); it != file.partitions.end(); ++it) {
+        const auto& [key, value] = *it;
+        // a column of the file, or an inner directory, takes precedence
+        auto same_key = [&key](const auto& partition) { return partition.first == key; };
+        if (std::find(header.begin(), header.end(), key) != header.end() ||
+            std::any_of(std::next(it), file.partitions.end(), same_key)) {
+            continue;
+        }
+        std::optional<DataType> cell{std::in_place, std::in_place_type<StringType>, value};
+        double number{0.0};
+        if (numeric_keys.count(key) > 0 && is_number(value, number)) {
+            cell = number;
+        }
+        frame.add_column(key, ColumnType(rows, cell));
+    }
+    return frame;
+}
+
+DataFrame Dataset::read(std::size_t prefetch) const
+{
+    SCI_PROFILE_SCOPE("Dataset::read");
+    prefetch = std::max<std::size_t>(prefetch, 1);
+    const std::size_t n = selected.size();
+    std::vector<std::string> contents(n);
+    std::vector<DataFrame> frames(n);
+
+    // a key is numeric only if its values are numbers in all the files, so
+    // that every partition column has a single type once concatenated
+    std::set<std::string> numeric_keys;
+    for (const auto& key : partition_keys()) {
+        numeric_keys.insert(key);
+    }
+    for (const auto& file : selected) {
+        for (const auto& [key, value] : file.partitions) {
+            double number{0.0};
+            if (!is_number(value, number)) {
+                numeric_keys.erase(key);
+            }
+        }
+    }
+
+    // the loader reads the files in order and the parsers take them in order,
+    // at most `prefetch` files being loaded and not parsed yet
+    std::mutex mutex;
+    std::condition_variable loaded_cv, parsed_cv;
+    std::size_t loaded{0}, next{0}, in_memory{0}, bytes{0};
+    std::exception_ptr error;
+
+    auto fail = [&](const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!error) {
+            try {
+                throw;
+            } catch (const std::exception& e) {
+                error = std::make_exception_ptr(std::runtime_error("ERROR in function read(): " + path + ": " + e.what()));
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        loaded_cv.notify_all();
+        parsed_cv.notify_all();
+    };
+
+    std::thread loader([&]() {
+        for (std::size_t k = 0; k < n; ++k) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                parsed_cv.wait(lock, [&]() { return in_memory < prefetch || error; });
+                if (error) {
+                    return;
+                }
+            }
+            std::string content;
+            try {
+                content = load_file(selected[k].path);
+            } catch (...) {
+                fail(selected[k].path);
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                bytes += content.size();
+                contents[k] = std::move(content);
+                ++loaded;
+                ++in_memory;
+            }
+            loaded_cv.notify_one();
+        }
+    });
+
+    auto parse_files = [&]() {
+        while (true) {
+            std::size_t k{0};
+            std::string content;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                loaded_cv.wait(lock, [&]() { return next < loaded || next == n || error; });
+                if (error || next == n) {
+                    return;
+                }
+                k = next++;
+                content = std::move(contents[k]);
+            }
+            try {
+                frames[k] = parse(selected[k], content, numeric_keys);
+            } catch (...) {
+                fail(selected[k].path);
+                return;
+            }
+            content = std::string();    // release the file before asking for the next one
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --in_memory;
+            }
+            parsed_cv.notify_one();
+        }
+    };
+
+    // the calling thread parses as well
+    std::vector<std::thread> parsers;
+    for (unsigned int t = 1; t < std::min<std::size_t>(parallel::thread_count(), n); ++t) {
+        parsers.emplace_back(parse_files);
+    }
+    parse_files();
+    for (auto& parser : parsers) {
+        parser.join();
+    }
+    loader.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    SCI_PROFILE_COUNT("files", n);
+    SCI_PROFILE_COUNT("bytes", bytes);
+    return DataFrame::concat(frames);
+}
@@ -0,0 +1,306 @@
+#include <algorithm>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include "DecompressingBuffer.hpp"
+#include "Profiler.hpp"
+#ifdef SCI_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SCI_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// bytes read from the source at once
+constexpr std::size_t input_size = 1 << 16;
+
+#if !defined(SCI_HAVE_ZLIB) || !defined(SCI_HAVE_ZSTD)
+std::runtime_error unavailable(const char* format)
+{
+    return std::runtime_error(std::string("ERROR in DecompressingBuffer: the input is compressed with ") + format +
+                              ", which is not available in this build.");
+}
+#endif
+
+} // namespace
+
+DecompressingBuffer::DecompressingBuffer(std::istream& source, std::size_t block_size, std::size_t max_blocks)
+    : source(source), block_size(std::max<std::size_t>(block_size, 1)), max_blocks(std::max<std::size_t>(max_blocks, 1))
+{
+    setg(nullptr, nullptr, nullptr);
+    worker = std::thread(&DecompressingBuffer::run, this);
+}
+
+DecompressingBuffer::~DecompressingBuffer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    emptied.notify_all();
+    worker.join();
+}
+
+Compression DecompressingBuffer::detect(const char* bytes, std::size_t n)
+{
+    auto starts_with = [&](std::initializer_list<unsigned char> magic) {
+        if (n < magic.size()) {
+            return false;
+        }
+        std::size_t k{0};
+        for (unsigned char byte : magic) {
+            if (static_cast<unsigned char>(bytes[k++]) != byte) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (starts_with({0x1f, 0x8b})) {
+        return Compression::Gzip;
+    }
+    if (starts_with({0x28, 0xb5, 0x2f, 0xfd})) {
+        return Compression::Zstd;
+    }
+    return Compression::None;
+}
+
+bool DecompressingBuffer::available(Compression compression)
+{
+    switch (compression) {
+    case Compression::Gzip:
+#ifdef SCI_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case Compression::Zstd:
+#ifdef SCI_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return true;
+    }
+}
+
+DecompressingBuffer::int_type DecompressingBuffer::underflow()
+{
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        filled.wait(lock, [this]() { return !blocks.empty() || finished; });
+        if (blocks.empty()) {
+            // the blocks before an error are read first
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            return traits_type::eof();
+        }
+        current = std::move(blocks.front());
+        blocks.pop_front();
+    }
+    emptied.notify_one();
+    setg(current.data(), current.data(), current.data() + current.size());
+    return traits_type::to_int_type(*gptr());
+}
+
+bool DecompressingBuffer::push(std::string& block)
+{
+    SCI_PROFILE_COUNT("bytes", block.size());
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        emptied.wait(lock, [this]() { return blocks.size() < max_blocks || stopping; });
+        if (stopping) {
+            return false;
+        }
+        blocks.push_back(std::move(block));
+    }
+    filled.notify_one();
+    block = std::string();
+    return true;
+}
+
+std::size_t DecompressingBuffer::read_source(std::string& chunk, std::size_t size)
+{
+    chunk.resize(size);
+    source.read(chunk.data(), static_cast<std::streamsize>(size));
+    chunk.resize(static_cast<std::size_t>(source.gcount()));
+    SCI_PROFILE_COUNT("source_bytes", chunk.size());
+    return chunk.size();
+}
+
+void DecompressingBuffer::run()
+{
+    SCI_PROFILE_SCOPE("DecompressingBuffer::run");
+    try {
+        // the first bytes tell the format, they stay in the chunk to decompress
+        std::string chunk;
+        read_source(chunk, input_size);
+        switch (detect(chunk.data(), chunk.size())) {
+        case Compression::Gzip:
+            inflate_gzip(chunk);
+            break;
+        case Compression::Zstd:
+            decompress_zstd(chunk);
+            break;
+        case Compression::None:
+            pass_through(chunk);
+            break;
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    filled.notify_all();
+}
+
+void DecompressingBuffer::pass_through(std::string& chunk)
+{
+    while (!chunk.empty()) {
+        if (!push(chunk)) {
+            return;
+        }
+        read_source(chunk, block_size);
+    }
+}
+
+void DecompressingBuffer::inflate_gzip(std::string& chunk)
+{
+#ifdef SCI_HAVE_ZLIB
+    z_stream stream{};
+    // largest window, and a gzip or zlib header recognised automatically
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        throw std::runtime_error("ERROR in DecompressingBuffer: zlib could not be initialised.");
+    }
+    std::unique_ptr<z_stream, int (*)(z_streamp)> guard(&stream, inflateEnd);
+
+    std::string block(block_size, '\0');
+    std::size_t used{0};
+    stream.next_in = reinterpret_cast<Bytef*>(chunk.data());
+    stream.avail_in = static_cast<uInt>(chunk.size());
+    bool stream_end{false};
+    bool more_output{false};    // the last call filled the block, zlib may hold more
+    while (true) {
+        if (stream.avail_in == 0 && !more_output) {
+            if (read_source(chunk, input_size) == 0) {
+                break;
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(chunk.data());
+            stream.avail_in = static_cast<uInt>(chunk.size());
+        }
+        if (stream_end) {
+            if (stream.avail_in == 0) {
+                more_output = false;
+                continue;
+            }
+            // concatenated gzip files are decompressed one after the other
+            inflateReset(&stream);
+            stream_end = false;
+        }
+        stream.next_out = reinterpret_cast<Bytef*>(block.data() + used);
+        stream.avail_out = static_cast<uInt>(block_size - used);
+        int status = inflate(&stream, Z_NO_FLUSH);
+        if (status == Z_STREAM_END) {
+            stream_end = true;
+        } else if (status != Z_OK && status != Z_BUF_ERROR) {
+            throw std::runtime_error(std::string("ERROR in DecompressingBuffer: corrupted gzip data (") +
+                                     (stream.msg != nullptr ? stream.msg : "unknown error") + ").");
+        }
+        used = block_size - stream.avail_out;
+        more_output = stream.avail_out == 0;
+        if (used == block_size) {
+            if (!push(block)) {
+                return;
+            }
+            block.resize(block_size);
+            used = 0;
+        }
+    }
+    if (!stream_end) {
+        throw std::runtime_error("ERROR in DecompressingBuffer: truncated gzip data.");
+    }
+    block.resize(used);
+    if (!block.empty()) {
+        push(block);
+    }
+#else
+    static_cast<void>(chunk);
+    throw unavailable("gzip");
+#endif
+}
+
+void DecompressingBuffer::decompress_zstd(std::string& chunk)
+{
+#ifdef SCI_HAVE_ZSTD
+    std::unique_ptr<ZSTD_DCtx, std::size_t (*)(ZSTD_DCtx*)> context(ZSTD_createDCtx(), ZSTD_freeDCtx);
+    if (!context) {
+        throw std::runtime_error("ERROR in DecompressingBuffer: zstd could not be initialised.");
+    }
+
+    std::string block(block_size, '\0');
+    ZSTD_inBuffer in{chunk.data(), chunk.size(), 0};
+    ZSTD_outBuffer out{block.data(), block_size, 0};
+    std::size_t remaining{0};   // 0 at the end of a frame
+    bool more_output{false};
+    while (true) {
+        if (in.pos == in.size && !more_output) {
+            if (read_source(chunk, input_size) == 0) {
+                break;
+            }
+            in = ZSTD_inBuffer{chunk.data(), chunk.size(), 0};
+        }
+        remaining = ZSTD_decompressStream(context.get(), &out, &in);
+        if (ZSTD_isError(remaining)) {
+            throw std::runtime_error(std::string("ERROR in DecompressingBuffer: corrupted zstd data (") +
+                                     ZSTD_getErrorName(remaining) + ").");
+        }
+        more_output = out.pos == out.size;
+        if (out.pos == block_size) {
+            if (!push(block)) {
+                return;
+            }
+            block.resize(block_size);
+            out = ZSTD_outBuffer{block.data(), block_size, 0};
+        }
+    }
+    if (remaining != 0) {
+        throw std::runtime_error("ERROR in DecompressingBuffer: truncated zstd data.");
+    }
+    block.resize(out.pos);
+    if (!block.empty()) {
+        push(block);
+    }
+#else
+    static_cast<void>(chunk);
+    throw unavailable("zstd");
+#endif
+}
+
+DecompressingStream::DecompressingStream(std::istream& source)
+    : std::istream(nullptr), buffer(source)
+{
+    rdbuf(&buffer);
+    // the errors of the thread reach the reader instead of looking like the end of the data
+    exceptions(std::ios::badbit);
+}
+
+std::istream& DecompressingStream::wrap(std::istream& input, std::unique_ptr<DecompressingStream>& holder)
+{
+    // the first byte of the gzip and zstd signatures: a false positive is
+    // only passed through by the thread
+    auto first = input.peek();
+    if (first != 0x1f && first != 0x28) {
+        return input;
+    }
+    holder = std::make_unique<DecompressingStream>(input);
+    return *holder;
+}
@@ -0,0 +1,718 @@
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include "EncodedColumn.hpp"
+
+/* -------------------------------------------------------------------------- */
+/*                                BIT PACKING                                 */
+/* -------------------------------------------------------------------------- */
+
+namespace {
+
+// rows of a Delta column between two absolute values
+constexpr std::size_t delta_block{128};
+
+// rows summed in 64-bit integers before moving to double: integers are below 2^53
+constexpr std::size_t sum_block{512};
+
+// largest power of ten tried to turn the values into integers
+constexpr int max_decimals{9};
+
+std::size_t words_for(std::size_t bits)
+{
+    return (bits + 63) / 64;
+}
+
+// number of bits needed to store v
+unsigned bit_width(std::uint64_t v)
+{
+    unsigned width{0};
+    while (v != 0) {
+        ++width;
+        v >>= 1;
+    }
+    return width;
+}
+
+// write the i-th value of `width` bits (the words must be zero-initialised)
+void pack(std::vector<std::uint64_t>& words, std::size_t i, unsigned width, std::uint64_t v)
+{
+    if (width == 0) {
+        return;
+    }
+    std::size_t bit = i * width;
+    std::size_t word = bit / 64;
+    unsigned offset = bit % 64;
+    words[word] |= v << offset;
+    if (offset + width > 64) {
+        words[word + 1] |= v >> (64 - offset);
+    }
+}
+
+// read the i-th value of `width` bits
+std::uint64_t unpack(const std::vector<std::uint64_t>& words, std::size_t i, unsigned width)
+{
+    if (width == 0) {
+        return 0;
+    }
+    std::size_t bit = i * width;
+    std::size_t word = bit / 64;
+    unsigned offset = bit % 64;
+    std::uint64_t v = words[word] >> offset;
+    if (offset + width > 64) {
+        v |= words[word + 1] << (64 - offset);
+    }
+    return width == 64 ? v : v & ((std::uint64_t{1} << width) - 1);
+}
+
+// true if the two values have the same representation: unlike ==, it tells
+// 0.0 from -0.0 and matches a NaN, so the runs and constants are lossless
+bool same_bits(double a, double b)
+{
+    std::uint64_t x, y;
+    std::memcpy(&x, &a, sizeof(x));
+    std::memcpy(&y, &b, sizeof(y));
+    return x == y;
+}
+
+std::uint64_t zigzag(std::int64_t v)
+{
+    return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t v)
+{
+    return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+}
+
+bool bit_is_set(const std::vector<std::uint64_t>& bitmap, std::size_t i)
+{
+    return bitmap.empty() || ((bitmap[i / 64] >> (i % 64)) & 1);
+}
+
+} // namespace
+
+/* -------------------------------------------------------------------------- */
+/*                                  STORAGE                                   */
+/* -------------------------------------------------------------------------- */
+
+// a single layout for all the encodings, each one uses only its own fields
+struct EncodedColumn::Storage {
+    ColumnEncoding encoding{ColumnEncoding::Plain};
+    std::size_t rows{0};
+    std::size_t valid{0};
+
+    // bit i (least significant first) is set if row i is valid, empty if all the
+    // rows are valid; RunLength keeps the validity in its runs instead
+    std::vector<std::uint64_t> validity;
+
+    // Plain: one value per row (0 on null rows), read through `plain`, which points
+    // either to `values` or to a buffer kept alive by `owner`
+    std::vector<double> values;
+    const double* plain{nullptr};
+    std::shared_ptr<const void> owner;
+
+    // Constant
+    double constant{0};
+
+    // RunLength: value, end row (exclusive) and validity of every run
+    std::vector<double> run_values;
+    std::vector<std::size_t> run_ends;
+    std::vector<std::uint8_t> run_valid;
+
+    // Delta and FrameOfReference: a value is the integer divided by multiplier,
+    // the integers are stored in `width` bits each
+    double multiplier{1};
+    unsigned width{0};
+    std::vector<std::uint64_t> packed;
+
+    // FrameOfReference: integer = reference + packed
+    std::int64_t reference{0};
+
+    // Delta: integer at the first row of every block, the packed values are the
+    // zigzag differences from the previous row (0 on null rows)
+    std::vector<std::int64_t> block_start;
+
+    // the rows decoded by cells(), filled once on demand
+    mutable std::once_flag decoded_once;
+    mutable ColumnType decoded;
+
+    bool is_valid(std::size_t row) const
+    {
+        return bit_is_set(validity, row);
+    }
+
+    // integer of a FrameOfReference or Delta row
+    std::int64_t integer_at(std::size_t row) const
+    {
+        if (encoding == ColumnEncoding::FrameOfReference) {
+            return reference + static_cast<std::int64_t>(unpack(packed, row, width));
+        }
+        std::size_t block = row / delta_block;
+        std::int64_t q = block_start[block];
+        for (std::size_t i = block * delta_block + 1; i <= row; ++i) {
+            q += unzigzag(unpack(packed, i, width));
+        }
+        return q;
+    }
+};
+
+/* -------------------------------------------------------------------------- */
+/*                                  ENCODING                                  */
+/* -------------------------------------------------------------------------- */
+
+EncodedColumn::EncodedColumn(const ColumnType& column, ColumnEncoding encoding)
+{
+    auto s = std::make_shared<Storage>();
+    s->rows = column.size();
+
+    // Extract the values and the validity bitmap
+    std::vector<double> values(s->rows, 0.0);
+    std::vector<std::uint64_t> validity(words_for(s->rows), 0);
+    for (std::size_t row = 0; row < s->rows; ++row) {
+        const auto& cell = column[row];
+        if (!cell) {
+            continue;
+        }
+        if (!std::holds_alternative<double>(*cell)) {
+            throw std::invalid_argument("ERROR in EncodedColumn: only numeric columns can be encoded.");
+        }
+        values[row] = std::get<double>(*cell);
+        validity[row / 64] |= std::uint64_t{1} << (row % 64);
+        ++s->valid;
+    }
+    if (s->valid == s->rows) {
+        validity.clear();
+    }
+    auto is_valid = [&validity](std::size_t row) { return bit_is_set(validity, row); };
+
+    // Constant: every valid value is the same
+    bool constant{true};
+    std::optional<double> first;
+    for (std::size_t row = 0; row < s->rows && constant; ++row) {
+        if (is_valid(row)) {
+            if (!first) {
+                first = values[row];
+            } else if (!same_bits(values[row], *first)) {
+                constant = false;
+            }
+        }
+    }
+
+    // Smallest power of ten that turns every value into an exact integer
+    std::vector<std::int64_t> integers;
+    double multiplier{1};
+    bool scalable{false};
+    for (int decimals = 0; decimals <= max_decimals && !scalable; ++decimals, multiplier *= 10) {
+        integers.assign(s->rows, 0);
+        scalable = true;
+        for (std::size_t row = 0; row < s->rows && scalable; ++row) {
+            if (!is_valid(row)) {
+                continue;
+            }
+            double scaled = std::nearbyint(values[row] * multiplier);
+            // -0.0 would come back as 0.0 from the integer
+            if (!(std::fabs(scaled) < 9007199254740992.0) || scaled / multiplier != values[row] || (scaled == 0 && std::signbit(values[row]))) {
+                scalable = false;
+            } else {
+                integers[row] = static_cast<std::int64_t>(scaled);
+            }
+        }
+    }
+    if (scalable) {
+        multiplier /= 10;  // undo the last increment of the loop
+    }
+
+    // Size of the applicable encodings, in bytes
+    std::size_t validity_bytes = validity.size() * sizeof(std::uint64_t);
+    std::size_t runs{0};
+    for (std::size_t row = 0; row < s->rows; ++row) {
+        if (row == 0 || is_valid(row) != is_valid(row - 1) || (is_valid(row) && !same_bits(values[row], values[row - 1]))) {
+            ++runs;
+        }
+    }
+    std::int64_t lowest{0}, highest{0};
+    std::uint64_t largest_delta{0};
+    if (scalable) {
+        bool seen{false};
+        std::int64_t previous{0};
+        for (std::size_t row = 0; row < s->rows; ++row) {
+            if (!is_valid(row)) {
+                continue;
+            }
+            if (!seen) {
+                lowest = highest = integers[row];
+                seen = true;
+            }
+            lowest = std::min(lowest, integers[row]);
+            highest = std::max(highest, integers[row]);
+            if (row % delta_block != 0) {
+                largest_delta = std::max(largest_delta, zigzag(integers[row] - previous));
+            }
+            previous = integers[row];
+        }
+    }
+    unsigned for_width = bit_width(static_cast<std::uint64_t>(highest - lowest));
+    unsigned delta_width = bit_width(largest_delta);
+
+    auto bytes = [&](ColumnEncoding e) -> std::size_t {
+        switch (e) {
+            case ColumnEncoding::Plain:
+                return s->rows * sizeof(double) + validity_bytes;
+            case ColumnEncoding::Constant:
+                return sizeof(double) + validity_bytes;
+            case ColumnEncoding::RunLength:
+                return runs * (sizeof(double) + sizeof(std::size_t) + sizeof(std::uint8_t));
+            case ColumnEncoding::FrameOfReference:
+                return words_for(s->rows * for_width) * sizeof(std::uint64_t) + validity_bytes;
+            case ColumnEncoding::Delta:
+                return words_for(s->rows * delta_width) * sizeof(std::uint64_t) + validity_bytes
+                       + (s->rows + delta_block - 1) / delta_block * sizeof(std::int64_t);
+            default:
+                return std::numeric_limits<std::size_t>::max();
+        }
+    };
+
+    if (encoding == ColumnEncoding::Auto && constant) {
+        encoding = ColumnEncoding::Constant;
+    }
+    if (encoding == ColumnEncoding::Auto) {
+        encoding = ColumnEncoding::Plain;
+        std::vector<ColumnEncoding> candidates{ColumnEncoding::RunLength};
+        if (scalable) {
+            candidates.push_back(ColumnEncoding::FrameOfReference);
+            candidates.push_back(ColumnEncoding::Delta);
+        }
+        for (auto candidate : candidates) {
+            if (bytes(candidate) < bytes(encoding)) {
+                encoding = candidate;
+            }
+        }
+    }
+    if (encoding == ColumnEncoding::Constant && !constant) {
+        throw std::invalid_argument("ERROR in EncodedColumn: the column is not constant.");
+    }
+    if ((encoding == ColumnEncoding::Delta || encoding == ColumnEncoding::FrameOfReference) && !scalable) {
+        throw std::invalid_argument("ERROR in EncodedColumn: the values cannot be stored as scaled integers.");
+    }
+
+    // Build the chosen layout
+    s->encoding = encoding;
+    switch (encoding) {
+        case ColumnEncoding::Plain:
+            s->values = std::move(values);
+            s->plain = s->values.data();
+            s->validity = std::move(validity);
+            break;
+
+        case ColumnEncoding::Constant:
+            s->constant = first.value_or(0.0);
+            s->validity = std::move(validity);
+            break;
+
+        case ColumnEncoding::RunLength:
+            s->run_values.reserve(runs);
+            s->run_ends.reserve(runs);
+            s->run_valid.reserve(runs);
+            for (std::size_t row = 0; row < s->rows; ++row) {
+                bool valid = is_valid(row);
+                if (s->run_ends.empty() || valid != static_cast<bool>(s->run_valid.back())
+                    || (valid && !same_bits(values[row], s->run_values.back()))) {
+                    s->run_values.push_back(valid ? values[row] : 0.0);
+                    s->run_ends.push_back(row);
+                    s->run_valid.push_back(valid);
+                }
+                s->run_ends.back() = row + 1;
+            }
+            break;
+
+        case ColumnEncoding::FrameOfReference:
+            s->multiplier = multiplier;
+            s->reference = lowest;
+            s->width = for_width;
+            s->packed.assign(words_for(s->rows * for_width), 0);
+            for (std::size_t row = 0; row < s->rows; ++row) {
+                if (is_valid(row)) {
+                    pack(s->packed, row, for_width, static_cast<std::uint64_t>(integers[row] - lowest));
+                }
+            }
+            s->validity = std::move(validity);
+            break;
+
+        case ColumnEncoding::Delta: {
+            s->multiplier = multiplier;
+            s->width = delta_width;
+            s->packed.assign(words_for(s->rows * delta_width), 0);
+            // null rows repeat the previous integer, so their difference is 0
+            std::int64_t previous{0};
+            for (std::size_t row = 0; row < s->rows; ++row) {
+                std::int64_t q = is_valid(row) ? integers[row] : previous;
+                if (row % delta_block == 0) {
+                    s->block_start.push_back(q);
+                } else {
+                    pack(s->packed, row, delta_width, zigzag(q - previous));
+                }
+                previous = q;
+            }
+            s->validity = std::move(validity);
+            break;
+        }
+
+        default:
+            throw std::invalid_argument("ERROR in EncodedColumn: unknown encoding.");
+    }
+
+    storage = std::move(s);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                  DECODING                                  */
+/* -------------------------------------------------------------------------- */
+
+ColumnEncoding EncodedColumn::encoding() const
+{
+    return storage ? storage->encoding : ColumnEncoding::Plain;
+}
+
+std::size_t EncodedColumn::size() const
+{
+    return storage ? storage->rows : 0;
+}
+
+std::size_t EncodedColumn::count() const
+{
+    return storage ? storage->valid : 0;
+}
+
+EncodedColumn EncodedColumn::plain_view(const double* values, std::size_t rows, std::vector<std::uint64_t> validity, std::shared_ptr<const void> owner)
+{
+    if (!validity.empty() && validity.size() < words_for(rows)) {
+        throw std::invalid_argument("ERROR in EncodedColumn::plain_view(): the validity bitmap is too short.");
+    }
+    auto s = std::make_shared<Storage>();
+    s->encoding = ColumnEncoding::Plain;
+    s->rows = rows;
+    s->valid = rows;
+    if (!validity.empty()) {
+        // clear the bits past the last row, so that they are not counted
+        if (rows % 64 != 0) {
+            validity[rows / 64] &= (std::uint64_t{1} << (rows % 64)) - 1;
+        }
+        validity.resize(words_for(rows));
+        s->valid = 0;
+        for (std::uint64_t word : validity) {
+            s->valid += std::bitset<64>(word).count();
+        }
+    }
+    s->validity = std::move(validity);
+    s->plain = values;
+    s->owner = std::move(owner);
+
+    EncodedColumn column;
+    column.storage = std::move(s);
+    return column;
+}
+
+const double* EncodedColumn::plain_values() const
+{
+    return storage && storage->encoding == ColumnEncoding::Plain ? storage->plain : nullptr;
+}
+
+const std::uint64_t* EncodedColumn::validity_bitmap() const
+{
+    return storage && !storage->validity.empty() ? storage->validity.data() : nullptr;
+}
+
+std::shared_ptr<const void> EncodedColumn::buffers_owner() const
+{
+    return storage;
+}
+
+std::optional<double> EncodedColumn::at(std::size_t row) const
+{
+    if (row >= size()) {
+        throw std::out_of_range("ERROR in EncodedColumn::at(): row out of range.");
+    }
+    const Storage& s = *storage;
+    if (s.encoding == ColumnEncoding::RunLength) {
+        // the first run ending after the row contains it
+        std::size_t run = std::upper_bound(s.run_ends.begin(), s.run_ends.end(), row) - s.run_ends.begin();
+        return s.run_valid[run] ? std::optional<double>(s.run_values[run]) : std::nullopt;
+    }
+    if (!s.is_valid(row)) {
+        return std::nullopt;
+    }
+    switch (s.encoding) {
+        case ColumnEncoding::Plain:
+            return s.plain[row];
+        case ColumnEncoding::Constant:
+            return s.constant;
+        default:
+            return static_cast<double>(s.integer_at(row)) / s.multiplier;
+    }
+}
+
+ColumnType EncodedColumn::decode() const
+{
+    return decode(0, size());
+}
+
+const ColumnType& EncodedColumn::cells() const
+{
+    static const ColumnType empty;
+    if (!storage) {
+        return empty;
+    }
+    std::call_once(storage->decoded_once, [this]() { storage->decoded = decode(); });
+    return storage->decoded;
+}
+
+ColumnType EncodedColumn::decode(std::size_t begin, std::size_t end) const
+{
+    end = std::min(end, size());
+    ColumnType cells;
+    if (begin >= end) {
+        return cells;
+    }
+    cells.reserve(end - begin);
+    const Storage& s = *storage;
+
+    switch (s.encoding) {
+        case ColumnEncoding::RunLength: {
+            std::size_t run = std::upper_bound(s.run_ends.begin(), s.run_ends.end(), begin) - s.run_ends.begin();
+            for (std::size_t row = begin; row < end; ++row) {
+                if (row == s.run_ends[run]) {
+                    ++run;
+                }
+                if (s.run_valid[run]) {
+                    cells.emplace_back(s.run_values[run]);
+                } else {
+                    cells.emplace_back(std::nullopt);
+                }
+            }
+            break;
+        }
+        case ColumnEncoding::Delta: {
+            // decode the first row, then accumulate the differences
+            std::int64_t q = s.integer_at(begin);
+            for (std::size_t row = begin; row < end; ++row) {
+                if (row != begin) {
+                    q = row % delta_block == 0 ? s.block_start[row / delta_block]
+                                               : q + unzigzag(unpack(s.packed, row, s.width));
+                }
+                if (s.is_valid(row)) {
+                    cells.emplace_back(static_cast<double>(q) / s.multiplier);
+                } else {
+                    cells.emplace_back(std::nullopt);
+                }
+            }
+            break;
+        }
+        default:
+            for (std::size_t row = begin; row < end; ++row) {
+                auto value = at(row);
+                if (value) {
+                    cells.emplace_back(*value);
+                } else {
+                    cells.emplace_back(std::nullopt);
+                }
+            }
+    }
+    return cells;
+}
+
+template <typename F>
+void EncodedColumn::for_each_value(F&& f) const
+{
+    if (!storage) {
+        return;
+    }
+    const Storage& s = *storage;
+    switch (s.encoding) {
+        case ColumnEncoding::Plain:
+            for (std::size_t row = 0; row < s.rows; ++row) {
+                if (s.is_valid(row)) {
+                    f(s.plain[row]);
+                }
+            }
+            break;
+        case ColumnEncoding::Constant:
+            for (std::size_t i = 0; i < s.valid; ++i) {
+                f(s.constant);
+            }
+            break;
+        case ColumnEncoding::RunLength: {
+            std::size_t start{0};
+            for (std::size_t run = 0; run < s.run_ends.size(); ++run) {
+                if (s.run_valid[run]) {
+                    for (std::size_t row = start; row < s.run_ends[run]; ++row) {
+                        f(s.run_values[run]);
+                    }
+                }
+                start = s.run_ends[run];
+            }
+            break;
+        }
+        case ColumnEncoding::FrameOfReference:
+            for (std::size_t row = 0; row < s.rows; ++row) {
+                if (s.is_valid(row)) {
+                    f(static_cast<double>(s.reference + static_cast<std::int64_t>(unpack(s.packed, row, s.width))) / s.multiplier);
+                }
+            }
+            break;
+        case ColumnEncoding::Delta: {
+            std::int64_t q{0};
+            for (std::size_t row = 0; row < s.rows; ++row) {
+                q = row % delta_block == 0 ? s.block_start[row / delta_block]
+                                           : q + unzigzag(unpack(s.packed, row, s.width));
+                if (s.is_valid(row)) {
+                    f(static_cast<double>(q) / s.multiplier);
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+std::vector<double> EncodedColumn::values() const
+{
+    std::vector<double> result;
+    result.reserve(count());
+    for_each_value([&result](double v) { result.push_back(v); });
+    return result;
+}
+
+std::size_t EncodedColumn::memory_usage() const
+{
+    if (!storage) {
+        return 0;
+    }
+    const Storage& s = *storage;
+    return sizeof(Storage)
+           + s.validity.capacity() * sizeof(std::uint64_t)
+           + (s.owner ? s.rows : s.values.capacity()) * sizeof(double)
+           + s.run_values.capacity() * sizeof(double)
+           + s.run_ends.capacity() * sizeof(std::size_t)
+           + s.run_valid.capacity() * sizeof(std::uint8_t)
+           + s.packed.capacity() * sizeof(std::uint64_t)
+           + s.block_start.capacity() * sizeof(std::int64_t);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                STATISTICS                                  */
+/* -------------------------------------------------------------------------- */
+
+double EncodedColumn::sum() const
+{
+    if (count() == 0) {
+        throw std::runtime_error("ERROR in EncodedColumn::sum(): no values.");
+    }
+    const Storage& s = *storage;
+    switch (s.encoding) {
+        case ColumnEncoding::Constant:
+            return s.constant * static_cast<double>(s.valid);
+
+        case ColumnEncoding::RunLength: {
+            double total{0};
+            std::size_t start{0};
+            for (std::size_t run = 0; run < s.run_ends.size(); ++run) {
+                if (s.run_valid[run]) {
+                    total += s.run_values[run] * static_cast<double>(s.run_ends[run] - start);
+                }
+                start = s.run_ends[run];
+            }
+            return total;
+        }
+
+        case ColumnEncoding::FrameOfReference: {
+            // sum the offsets as integers, the reference is added once per value
+            double total{0};
+            for (std::size_t first = 0; first < s.rows; first += sum_block) {
+                std::uint64_t partial{0};
+                for (std::size_t row = first; row < std::min(s.rows, first + sum_block); ++row) {
+                    if (s.is_valid(row)) {
+                        partial += unpack(s.packed, row, s.width);
+                    }
+                }
+                total += static_cast<double>(partial);
+            }
+            return (total + static_cast<double>(s.reference) * static_cast<double>(s.valid)) / s.multiplier;
+        }
+
+        case ColumnEncoding::Delta: {
+            double total{0};
+            std::int64_t q{0};
+            for (std::size_t first = 0; first < s.rows; first += sum_block) {
+                std::int64_t partial{0};
+                for (std::size_t row = first; row < std::min(s.rows, first + sum_block); ++row) {
+                    q = row % delta_block == 0 ? s.block_start[row / delta_block]
+                                               : q + unzigzag(unpack(s.packed, row, s.width));
+                    if (s.is_valid(row)) {
+                        partial += q;
+                    }
+                }
+                total += static_cast<double>(partial);
+            }
+            return total / s.multiplier;
+        }
+
+        default: {
+            double total{0};
+            for_each_value([&total](double v) { total += v; });
+            return total;
+        }
+    }
+}
+
+double EncodedColumn::min() const
+{
+    if (count() == 0) {
+        throw std::runtime_error("ERROR in EncodedColumn::min(): no values.");
+    }
+    const Storage& s = *storage;
+    if (s.encoding == ColumnEncoding::Constant) {
+        return s.constant;
+    }
+    if (s.encoding == ColumnEncoding::RunLength) {
+        double result{std::numeric_limits<double>::infinity()};
+        for (std::size_t run = 0; run < s.run_values.size(); ++run) {
+            if (s.run_valid[run]) {
+                result = std::min(result, s.run_values[run]);
+            }
+        }
+        return result;
+    }
+    double result{std::numeric_limits<double>::infinity()};
+    for_each_value([&result](double v) { result = std::min(result, v); });
+    return result;
+}
+
+double EncodedColumn::max() const
+{
+    if (count() == 0) {
+        throw std::runtime_error("ERROR in EncodedColumn::max(): no values.");
+    }
+    const Storage& s = *storage;
+    if (s.encoding == ColumnEncoding::Constant) {
+        return s.constant;
+    }
+    if (s.encoding == ColumnEncoding::RunLength) {
+        double result{-std::numeric_limits<double>::infinity()};
+        for (std::size_t run = 0; run < s.run_values.size(); ++run) {
+            if (s.run_valid[run]) {
+                result = std::max(result, s.run_values[run]);
+            }
+        }
+        return result;
+    }
+    double result{-std::numeric_limits<double>::infinity()};
+    for_each_value([&result](double v) { result = std::max(result, v); });
+    return result;
+}
@@ -0,0 +1,144 @@
+#include "GridInterpolator.hpp"
+#include "Interpolator.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+GridInterpolator::GridInterpolator(const std::vector<std::vector<double>>& axes, const std::vector<double>& values,
+                                   Method method)
+    : axes(axes), values(values), method(method) {
+    if (axes.empty()) {
+        throw std::invalid_argument("At least one axis is required for grid interpolation.");
+    }
+    std::size_t size = 1;
+    for (const auto& axis : axes) {
+        Interpolator::validate_nodes(axis.data(), axis.size(), axis.size());
+        searches.emplace_back(axis);
+        size *= axis.size();
+    }
+    if (values.size() != size) {
+        throw std::invalid_argument("The number of values must be the product of the sizes of the axes.");
+    }
+    strides.assign(axes.size(), 1);
+    for (std::size_t a = axes.size() - 1; a-- > 0;) {
+        strides[a] = strides[a + 1] * axes[a + 1].size();
+    }
+    SCI_PROFILE_COUNT("nodes", size);
+}
+
+void GridInterpolator::axis_weights(std::size_t axis, double x, std::size_t i, std::size_t* index, double* weight) const {
+    const std::vector<double>& nodes = axes[axis];
+    const std::size_t stride = strides[axis];
+    const double h = nodes[i + 1] - nodes[i];
+    const double t = (x - nodes[i]) / h;
+    if (method == Method::Linear) {
+        index[0] = i * stride;
+        index[1] = (i + 1) * stride;
+        weight[0] = 1.0 - t;
+        weight[1] = t;
+        return;
+    }
+
+    // Hermite basis on [x_i, x_{i+1}]: f_i, h m_i, f_{i+1}, h m_{i+1}
+    const double t2 = t * t;
+    const double t3 = t2 * t;
+    const double h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+    const double h10 = (t3 - 2.0 * t2 + t) * h;
+    const double h01 = -2.0 * t3 + 3.0 * t2;
+    const double h11 = (t3 - t2) * h;
+
+    // the values at i-1, i, i+1, i+2 (the missing ones at the ends with no weight)
+    const std::size_t n = nodes.size();
+    index[0] = (i > 0 ? i - 1 : i) * stride;
+    index[1] = i * stride;
+    index[2] = (i + 1) * stride;
+    index[3] = (i + 2 < n ? i + 2 : i + 1) * stride;
+    weight[0] = 0.0;
+    weight[1] = h00;
+    weight[2] = h01;
+    weight[3] = 0.0;
+    // m_i: centred difference, one-sided at the first node
+    if (i > 0) {
+        double slope = h10 / (nodes[i + 1] - nodes[i - 1]);
+        weight[2] += slope;
+        weight[0] -= slope;
+    } else {
+        weight[2] += h10 / h;
+        weight[1] -= h10 / h;
+    }
+    // m_{i+1}: same, one-sided at the last node
+    if (i + 2 < n) {
+        double slope = h11 / (nodes[i + 2] - nodes[i]);
+        weight[3] += slope;
+        weight[1] -= slope;
+    } else {
+        weight[2] += h11 / h;
+        weight[1] -= h11 / h;
+    }
+}
+
+void GridInterpolator::evaluate(const double* points, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("GridInterpolator::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    const std::size_t d = axes.size();
+    for (std::size_t k = 0; k < n; ++k) {
+        for (std::size_t a = 0; a < d; ++a) {
+            Interpolator::validate_point(points[k * d + a], axes[a].front(), axes[a].back());
+        }
+    }
+
+    const std::size_t width = method == Method::Linear ? 2 : 4;
+    std::size_t corners = 1;
+    for (std::size_t a = 0; a < d; ++a) {
+        corners *= width;
+    }
+    std::vector<std::size_t> hint(d, 0), index(width);
+    std::vector<double> weight(width);
+    // offsets and weights of the corners, extended by one axis at a time
+    std::vector<std::size_t> offsets(corners);
+    std::vector<double> products(corners);
+    for (std::size_t k = 0; k < n; ++k) {
+        const double* point = points + k * d;
+        offsets[0] = 0;
+        products[0] = 1.0;
+        std::size_t count = 1;
+        for (std::size_t a = 0; a < d; ++a) {
+            hint[a] = searches[a].find_from(axes[a], point[a], hint[a]);
+            axis_weights(a, point[a], hint[a], index.data(), weight.data());
+            // in place, from the end, so that the entries read are not yet overwritten
+            for (std::size_t c = count; c-- > 0;) {
+                const std::size_t offset = offsets[c];
+                const double product = products[c];
+                for (std::size_t j = 0; j < width; ++j) {
+                    offsets[c * width + j] = offset + index[j];
+                    products[c * width + j] = product * weight[j];
+                }
+            }
+            count *= width;
+        }
+
+        double result = 0.0;
+        for (std::size_t c = 0; c < corners; ++c) {
+            result += products[c] * values[offsets[c]];
+        }
+        out[k] = result;
+    }
+}
+
+std::vector<double> GridInterpolator::evaluate(const std::vector<double>& points) const {
+    if (points.size() % axes.size() != 0) {
+        throw std::invalid_argument("The number of coordinates must be a multiple of the dimension.");
+    }
+    std::vector<double> out(points.size() / axes.size());
+    evaluate(points.data(), out.data(), out.size());
+    return out;
+}
+
+double GridInterpolator::operator()(const std::vector<double>& point) const {
+    if (point.size() != axes.size()) {
+        throw std::invalid_argument("The point must have one coordinate per axis.");
+    }
+    double out{0.0};
+    evaluate(point.data(), &out, 1);
+    return out;
+}
@@ -1,8 +1,23 @@
 #include "GslPolynomialInterpolator.hpp"
+#include "PiecewisePolynomial.hpp"
+#include "Profiler.hpp"
+#include <new>
 #include <stdexcept>
+#include <utility>
 
 // The gsl library is used to implement Lagrangian polynomial interpolation
 
+GslPolynomialInterpolator::Cursor::Cursor()
+    : acc(gsl_interp_accel_alloc()) {
+    if (!acc) {
+        throw std::bad_alloc();
+    }
+}
+
+void GslPolynomialInterpolator::Cursor::reset() {
+    gsl_interp_accel_reset(acc.get());
+}
+
 GslPolynomialInterpolator::GslPolynomialInterpolator(const std::vector<double>& x, const std::vector<double>& y) {
     // Call setData to store the data
     set_data(x, y);  
@@ -10,32 +25,59 @@ GslPolynomialInterpolator::GslPolynomialInterpolator(const std::vector<double>&
     compute_coefficients();
 } 
 
+GslPolynomialInterpolator::GslPolynomialInterpolator(const GslPolynomialInterpolator& other)
+    : Interpolator(other) {
+    // The GSL interpolator refers to nothing but its own coefficients, recomputed here
+    compute_coefficients();
+}
+
+GslPolynomialInterpolator& GslPolynomialInterpolator::operator=(const GslPolynomialInterpolator& other) {
+    if (this != &other) {
+        GslPolynomialInterpolator copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
 void GslPolynomialInterpolator::compute_coefficients() {
+    SCI_PROFILE_SCOPE("GslPolynomialInterpolator::compute_coefficients");
     std::size_t n = x_nodes.size();
 
-    // Create GSL interpolator (polynomial) and accelerator
-    interp = gsl_interp_alloc(gsl_interp_polynomial, n);
-    acc = gsl_interp_accel_alloc();
+    // Create GSL interpolator (polynomial)
+    interp.reset(gsl_interp_alloc(gsl_interp_polynomial, n));
+    if (!interp) {
+        throw std::runtime_error("Error allocating gsl interpolator.");
+    }
 
     // Set the input data in the gsl interpolator
-    int status = gsl_interp_init(interp, x_nodes.data(), y_nodes.data(), n);
+    int status = gsl_interp_init(interp.get(), x_nodes.data(), y_nodes.data(), n);
     if (status != GSL_SUCCESS) {
         throw std::runtime_error("Error initialising gsl interpolator.");
     }  
 }
     
 double GslPolynomialInterpolator::operator()(double x) const {
-    // We use GSL to calculate the interpolation at the point x
+    // We use GSL to calculate the interpolation at the point x; without
+    // accelerator nothing is shared between concurrent calls
     check_range(x);
-    return gsl_interp_eval(interp, x_nodes.data(), y_nodes.data(), x, acc);
+    return gsl_interp_eval(interp.get(), x_nodes.data(), y_nodes.data(), x, nullptr);
 }
 
-GslPolynomialInterpolator::~GslPolynomialInterpolator() {
-    // We release GSL resources if they have been initialised
-    if (interp != nullptr) {
-        gsl_interp_free(interp);
-    }
-    if (acc != nullptr) {
-        gsl_interp_accel_free(acc);
+double GslPolynomialInterpolator::operator()(double x, Cursor& cursor) const {
+    check_range(x);
+    return gsl_interp_eval(interp.get(), x_nodes.data(), y_nodes.data(), x, cursor.acc.get());
+}
+
+void GslPolynomialInterpolator::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("GslPolynomialInterpolator::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    check_range(xs, n);
+    // the polynomial evaluation ignores the accelerator: none is allocated
+    for (std::size_t k = 0; k < n; ++k) {
+        out[k] = gsl_interp_eval(interp.get(), x_nodes.data(), y_nodes.data(), xs[k], nullptr);
     }
 }
+
+PiecewisePolynomial GslPolynomialInterpolator::to_piecewise() const {
+    return PiecewisePolynomial::interpolating_polynomial(x_nodes, y_nodes);
+}
@@ -1,36 +1,52 @@
 #include "Interpolator.hpp"
+#include "Parallel.hpp"
+#include "Profiler.hpp"
 #include <stdexcept>
 
 // Definition of the setData method and issues that we can experience
 void Interpolator::set_data(const std::vector<double>& x, const std::vector<double>& y) {
-    if (x.size() != y.size() || x.empty()) {
-        throw std::invalid_argument("Vectors x and y must have the same non-zero size.");
-    }
-    if (x.size() < 2 || y.size() < 2) {
-        throw std::invalid_argument("At least two nodes are required for interpolation.");
-    }
-    // Check for duplicate x-values
-    for (size_t i = 1; i < x.size(); ++i) {
-        if (x[i] == x[i - 1]) {
-            throw std::invalid_argument("Duplicate x-values detected. x-values must be unique.");
-        }
-    }
-    // Ensure x-values are strictly increasing
-    for (size_t i = 1; i < x.size(); ++i) {
-    if (x[i] <= x[i - 1]) {
-        throw std::invalid_argument("x-values must be strictly increasing.");
-    }
-}
+    SCI_PROFILE_SCOPE("Interpolator::set_data");
+    validate_nodes(x.data(), x.size(), y.size());
 
     x_nodes = x;
     y_nodes = y;
+    SCI_PROFILE_COUNT("nodes", x.size());
 }
 
 //  Prevent invalid queries or extrapolation in unsupported methods
 void Interpolator::check_range(double x) const {
-    if (x < x_nodes.front() || x > x_nodes.back()) {
+    validate_point(x, x_nodes.front(), x_nodes.back());
+}
+
+void Interpolator::check_range(const double* xs, std::size_t n) const {
+    const double front = x_nodes.front();
+    const double back = x_nodes.back();
+    bool outside = false;
+    for (std::size_t k = 0; k < n; ++k) {
+        outside |= !(xs[k] >= front && xs[k] <= back);
+    }
+    if (outside) {
         throw std::out_of_range("x is outside the interpolation range.");
     }
 }
 
+// Default batch evaluation, for the subclasses without a faster one
+void Interpolator::evaluate(const double* xs, double* out, std::size_t n) const {
+    check_range(xs, n);
+    for (std::size_t k = 0; k < n; ++k) {
+        out[k] = (*this)(xs[k]);
+    }
+}
+
+std::vector<double> Interpolator::evaluate(const std::vector<double>& xs) const {
+    std::vector<double> out(xs.size());
+    evaluate(xs.data(), out.data(), xs.size());
+    return out;
+}
 
+void Interpolator::evaluate_parallel(const double* xs, double* out, std::size_t n, std::size_t min_chunk) const {
+    SCI_PROFILE_SCOPE("Interpolator::evaluate_parallel");
+    parallel::for_chunks(n, min_chunk, [&](std::size_t begin, std::size_t end) {
+        evaluate(xs + begin, out + begin, end - begin);
+    });
+}
@@ -0,0 +1,67 @@
+#include "IntervalSearch.hpp"
+#include <algorithm>
+#include <cmath>
+
+IntervalSearch::IntervalSearch(const std::vector<double>& x) {
+    const std::size_t n = x.size();
+    if (n < 2) {
+        return;
+    }
+    // Equal spacing: every node within rounding of its place on the regular grid
+    double step = (x.back() - x.front()) / static_cast<double>(n - 1);
+    constexpr double tolerance = 1e-9;  // relative to the step
+    uniform_spacing = true;
+    for (std::size_t i = 1; i + 1 < n && uniform_spacing; ++i) {
+        double expected = x.front() + static_cast<double>(i) * step;
+        uniform_spacing = std::fabs(x[i] - expected) <= tolerance * step;
+    }
+    inverse_step = uniform_spacing ? 1.0 / step : 0.0;
+}
+
+std::size_t IntervalSearch::find(const std::vector<double>& x, double point) const {
+    const std::size_t last = x.size() - 2;    // index of the last interval
+    if (uniform_spacing) {
+        double position = (point - x.front()) * inverse_step;
+        std::size_t i = position < static_cast<double>(last) ? static_cast<std::size_t>(position) : last;
+        // The rounding of the division can only be one interval off
+        if (i > 0 && point < x[i]) {
+            --i;
+        } else if (i < last && point >= x[i + 1]) {
+            ++i;
+        }
+        return i;
+    }
+
+    // Branchless binary search for the last of x[0..last] not greater than the point:
+    // the comparison only selects the next base, which compiles to a conditional move
+    const double* base = x.data();
+    std::size_t length = last + 1;
+    while (length > 1) {
+        std::size_t half = length / 2;
+        base = base[half] <= point ? base + half : base;
+        length -= half;
+    }
+    return static_cast<std::size_t>(base - x.data());
+}
+
+std::size_t IntervalSearch::find_from(const std::vector<double>& x, double point, std::size_t hint) const {
+    const std::size_t last = x.size() - 2;
+    constexpr std::size_t max_steps = 8;
+    std::size_t i = std::min(hint, last);
+    if (point >= x[i] && point < x[i + 1]) {
+        return i;
+    }
+    if (uniform_spacing) {
+        return find(x, point);
+    }
+    // A few steps forward are cheaper than a search for sorted points,
+    // taken only if they reach the point
+    std::size_t stop = std::min(i + max_steps, last);
+    if (point >= x[i + 1] && point < x[stop + 1]) {
+        while (point >= x[i + 1]) {
+            ++i;
+        }
+        return i;
+    }
+    return find(x, point);
+}
@@ -1,21 +1,40 @@
 #include "LinearInterpolator.hpp"
+#include "PiecewisePolynomial.hpp"
+#include "Profiler.hpp"
 
 // Constructor: initialises the data using setData
 LinearInterpolator::LinearInterpolator(const std::vector<double>& x, const std::vector<double>& y) {
     set_data(x, y); // Verify and store data
+
+    const std::size_t n = x_nodes.size();
+    slopes.resize(n - 1);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        slopes[i] = (y_nodes[i + 1] - y_nodes[i]) / (x_nodes[i + 1] - x_nodes[i]);
+    }
+    search = IntervalSearch(x_nodes);
 }
 
 double LinearInterpolator::operator()(double x) const {
     check_range(x);
 
     // Finds the interval [x_nodes[i], x_nodes[i+1]] where x is located
-    for (size_t i = 0; i < x_nodes.size() - 1; ++i) {
-        if (x >= x_nodes[i] && x <= x_nodes[i + 1]) {
-            // Calculates the slope and returns the interpolated value
-            double slope = (y_nodes[i + 1] - y_nodes[i]) / (x_nodes[i + 1] - x_nodes[i]);
-            return y_nodes[i] + slope * (x - x_nodes[i]); // y = y_i + slope * (x - x_i)
-        }
+    std::size_t i = search.find(x_nodes, x);
+    return y_nodes[i] + slopes[i] * (x - x_nodes[i]); // y = y_i + slope * (x - x_i)
+}
+
+void LinearInterpolator::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("LinearInterpolator::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    check_range(xs, n);
+    std::size_t i = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        double x = xs[k];
+        i = search.find_from(x_nodes, x, i);
+        out[k] = y_nodes[i] + slopes[i] * (x - x_nodes[i]);
     }
+}
 
-     throw std::runtime_error("Interpolation failed. x should be within the data range.");
+PiecewisePolynomial LinearInterpolator::to_piecewise() const {
+    std::vector<double> values(y_nodes.begin(), y_nodes.end() - 1);
+    return PiecewisePolynomial(x_nodes, {values, slopes});
 }
@@ -0,0 +1,80 @@
+#include "MultiOutputInterpolator.hpp"
+#include "Interpolator.hpp"
+#include "Profiler.hpp"
+#include <stdexcept>
+
+MultiOutputInterpolator::MultiOutputInterpolator(const std::vector<double>& x,
+                                                 const std::vector<std::vector<double>>& series)
+    : x_nodes(x), m(series.size()) {
+    if (series.empty()) {
+        throw std::invalid_argument("At least one series is required for interpolation.");
+    }
+    values.resize(x.size() * m);
+    for (std::size_t j = 0; j < m; ++j) {
+        Interpolator::validate_nodes(x.data(), x.size(), series[j].size());
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            values[i * m + j] = series[j][i];
+        }
+    }
+    compute_slopes();
+}
+
+MultiOutputInterpolator::MultiOutputInterpolator(const std::vector<double>& x, const std::vector<double>& values,
+                                                 std::size_t outputs)
+    : x_nodes(x), m(outputs), values(values) {
+    if (outputs == 0 || values.size() % outputs != 0) {
+        throw std::invalid_argument("The values must be a matrix with one column per series.");
+    }
+    Interpolator::validate_nodes(x.data(), x.size(), values.size() / outputs);
+    compute_slopes();
+}
+
+void MultiOutputInterpolator::compute_slopes() {
+    SCI_PROFILE_SCOPE("MultiOutputInterpolator::compute_slopes");
+    const std::size_t n = x_nodes.size();
+    slopes.resize((n - 1) * m);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        const double inverse = 1.0 / (x_nodes[i + 1] - x_nodes[i]);
+        const double* left = values.data() + i * m;
+        const double* right = left + m;
+        double* slope = slopes.data() + i * m;
+        for (std::size_t j = 0; j < m; ++j) {
+            slope[j] = (right[j] - left[j]) * inverse;
+        }
+    }
+    search = IntervalSearch(x_nodes);
+    SCI_PROFILE_COUNT("values", values.size());
+}
+
+void MultiOutputInterpolator::interpolate(std::size_t i, double x, double* out) const {
+    const double dx = x - x_nodes[i];
+    const double* value = values.data() + i * m;
+    const double* slope = slopes.data() + i * m;
+    for (std::size_t j = 0; j < m; ++j) {
+        out[j] = value[j] + slope[j] * dx;
+    }
+}
+
+void MultiOutputInterpolator::operator()(double x, double* out) const {
+    Interpolator::validate_point(x, x_nodes.front(), x_nodes.back());
+    interpolate(search.find(x_nodes, x), x, out);
+}
+
+std::vector<double> MultiOutputInterpolator::operator()(double x) const {
+    std::vector<double> out(m);
+    (*this)(x, out.data());
+    return out;
+}
+
+void MultiOutputInterpolator::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("MultiOutputInterpolator::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    for (std::size_t k = 0; k < n; ++k) {
+        Interpolator::validate_point(xs[k], x_nodes.front(), x_nodes.back());
+    }
+    std::size_t i = 0;
+    for (std::size_t k = 0; k < n; ++k) {
+        i = search.find_from(x_nodes, xs[k], i);
+        interpolate(i, xs[k], out + k * m);
+    }
+}
@@ -1,4 +1,9 @@
 #include "NewtonInterpolator.hpp"
+#include "PiecewisePolynomial.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 NewtonInterpolator::NewtonInterpolator(const std::vector<double>& x, const std::vector<double>& y) {
     // Call setData to store the data
@@ -9,32 +14,91 @@ NewtonInterpolator::NewtonInterpolator(const std::vector<double>& x, const std::
 
 // Method for calculating Newton's coefficients (split differences)
 void NewtonInterpolator::compute_coefficients() {
+    SCI_PROFILE_SCOPE("NewtonInterpolator::compute_coefficients");
     std::size_t n = x_nodes.size();
-    coefficients.resize(n); // These coefficients represent the split differences f[x0], f[x0,x1],...
+    // These coefficients represent the split differences f[x0], f[x0,x1],...
+    coefficients.clear();
+    newton_nodes.clear();
+    diagonal.clear();
+    coefficients.reserve(n);
+    newton_nodes.reserve(n);
+    diagonal.reserve(n);
 
-// Copy the values of y into the first set of coefficients (P(x) = f[x0] + ...)
+    // The table is built one node at a time, as add_node does
     for (std::size_t i = 0; i < n; ++i) {
-        coefficients[i] = y_nodes[i]; // the values of yi are copied to the vector coefficients
+        extend_table(x_nodes[i], y_nodes[i]);
     }
+}
 
-    // Calculate Newton's divided differences
-    for (std::size_t j = 1; j < n; ++j) {
-        for (std::size_t i = n - 1; i >= j; --i) {
-            coefficients[i] = (coefficients[i] - coefficients[i - 1]) / (x_nodes[i] - x_nodes[i - j]);
-        }
+void NewtonInterpolator::extend_table(double x, double y) {
+    const std::size_t n = newton_nodes.size();
+    newton_nodes.push_back(x);
+    // f[x_{n-k}, ..., x_n] from f[x_{n-k+1}, ..., x_n] and the previous row
+    double difference = y;
+    for (std::size_t k = 0; k < n; ++k) {
+        double next = (difference - diagonal[k]) / (x - newton_nodes[n - 1 - k]);
+        diagonal[k] = difference;
+        difference = next;
+    }
+    diagonal.push_back(difference);
+    coefficients.push_back(difference);
+}
+
+void NewtonInterpolator::add_node(double x, double y) {
+    SCI_PROFILE_SCOPE("NewtonInterpolator::add_node");
+    if (!std::isfinite(x)) {
+        throw std::invalid_argument("x-values must be finite.");
+    }
+    auto it = std::lower_bound(x_nodes.begin(), x_nodes.end(), x);
+    if (it != x_nodes.end() && *it == x) {
+        throw std::invalid_argument("Duplicate x-values detected. x-values must be unique.");
     }
+
+    extend_table(x, y);
+
+    // The nodes stay sorted, for check_range and to_piecewise
+    std::size_t position = static_cast<std::size_t>(it - x_nodes.begin());
+    x_nodes.insert(x_nodes.begin() + position, x);
+    y_nodes.insert(y_nodes.begin() + position, y);
+    SCI_PROFILE_COUNT("nodes", x_nodes.size());
 }
 
 // Operator overload to perform interpolation on the value ‘x’
 double NewtonInterpolator::operator()(double x) const {
     check_range(x);
-    std::size_t n = x_nodes.size();
+    std::size_t n = newton_nodes.size();
     double result = coefficients[n - 1];
 
     // Evaluation of Newton's polynomial using Horner's formula
     for (int i = static_cast<int>(n) - 2; i >= 0; --i) {
-        result = result * (x - x_nodes[i]) + coefficients[i];
+        result = result * (x - newton_nodes[i]) + coefficients[i];
     }
 
     return result;
 }
+
+void NewtonInterpolator::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("NewtonInterpolator::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    check_range(xs, n);
+    // Points per block: the partial results stay in the L1 cache
+    constexpr std::size_t block = 256;
+    const std::size_t n_nodes = newton_nodes.size();
+    for (std::size_t begin = 0; begin < n; begin += block) {
+        const std::size_t end = std::min(n, begin + block);
+        for (std::size_t k = begin; k < end; ++k) {
+            out[k] = coefficients[n_nodes - 1];
+        }
+        for (std::size_t i = n_nodes - 1; i-- > 0;) {
+            const double node = newton_nodes[i];
+            const double coefficient = coefficients[i];
+            for (std::size_t k = begin; k < end; ++k) {
+                out[k] = out[k] * (xs[k] - node) + coefficient;
+            }
+        }
+    }
+}
+
+PiecewisePolynomial NewtonInterpolator::to_piecewise() const {
+    return PiecewisePolynomial::interpolating_polynomial(x_nodes, y_nodes);
+}
@@ -0,0 +1,159 @@
+#include "PiecewisePolynomial.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+PiecewisePolynomial::PiecewisePolynomial(const std::vector<double>& breakpoints,
+                                         const std::vector<std::vector<double>>& coefficients) {
+    const std::size_t n = breakpoints.size();
+    if (coefficients.empty()) {
+        throw std::invalid_argument("At least one coefficient per interval is required.");
+    }
+    for (const auto& power : coefficients) {
+        if (n < 2 || power.size() != n - 1) {
+            throw std::invalid_argument("Each power must have one coefficient per interval.");
+        }
+    }
+    pieces = n - 1;
+    terms = coefficients.size();
+    this->coefficients.resize(terms * pieces);
+    for (std::size_t k = 0; k < terms; ++k) {
+        std::copy(coefficients[k].begin(), coefficients[k].end(), this->coefficients.begin() + k * pieces);
+    }
+
+    // The values at the breakpoints are the nodes of the interpolator
+    std::vector<double> values(n);
+    for (std::size_t i = 0; i < pieces; ++i) {
+        values[i] = coefficient(0, i);
+    }
+    double h = breakpoints[n - 1] - breakpoints[n - 2];
+    values[n - 1] = coefficient(terms - 1, pieces - 1);
+    for (std::size_t k = terms - 1; k-- > 0;) {
+        values[n - 1] = values[n - 1] * h + coefficient(k, pieces - 1);
+    }
+    set_data(breakpoints, values);
+    search = IntervalSearch(x_nodes);
+
+    cumulative.assign(n, 0.0);
+    for (std::size_t i = 0; i < pieces; ++i) {
+        cumulative[i + 1] = cumulative[i] + partial_integral(i, x_nodes[i + 1] - x_nodes[i]);
+    }
+}
+
+PiecewisePolynomial PiecewisePolynomial::interpolating_polynomial(const std::vector<double>& x, const std::vector<double>& y) {
+    SCI_PROFILE_SCOPE("PiecewisePolynomial::interpolating_polynomial");
+    if (x.size() != y.size() || x.size() < 2) {
+        throw std::invalid_argument("Vectors x and y must have the same size, at least two.");
+    }
+    // Newton's divided differences
+    const std::size_t n = x.size();
+    std::vector<double> divided(y);
+    for (std::size_t j = 1; j < n; ++j) {
+        for (std::size_t i = n - 1; i >= j; --i) {
+            divided[i] = (divided[i] - divided[i - 1]) / (x[i] - x[i - j]);
+        }
+    }
+
+    // Horner's formula on polynomials in t = x - x_i:
+    // q <- q (t + x_i - x_j) + divided[j], for j = n-2 .. 0
+    std::vector<std::vector<double>> coefficients(n, std::vector<double>(n - 1, 0.0));
+    std::vector<double> q(n);
+    for (std::size_t i = 0; i + 1 < n; ++i) {
+        std::fill(q.begin(), q.end(), 0.0);
+        q[0] = divided[n - 1];
+        std::size_t size = 1;
+        for (std::size_t j = n - 1; j-- > 0;) {
+            double shift = x[i] - x[j];
+            for (std::size_t m = size; m > 0; --m) {
+                q[m] = q[m - 1] + shift * q[m];
+            }
+            q[0] = shift * q[0] + divided[j];
+            ++size;
+        }
+        for (std::size_t k = 0; k < n; ++k) {
+            coefficients[k][i] = q[k];
+        }
+    }
+    return PiecewisePolynomial(x, coefficients);
+}
+
+double PiecewisePolynomial::operator()(double x) const {
+    check_range(x);
+    std::size_t i = search.find(x_nodes, x);
+    double t = x - x_nodes[i];
+    double result = coefficient(terms - 1, i);
+    for (std::size_t k = terms - 1; k-- > 0;) {
+        result = result * t + coefficient(k, i);
+    }
+    return result;
+}
+
+void PiecewisePolynomial::evaluate(const double* xs, double* out, std::size_t n) const {
+    SCI_PROFILE_SCOPE("PiecewisePolynomial::evaluate");
+    SCI_PROFILE_COUNT("points", n);
+    check_range(xs, n);
+    std::size_t i = 0;
+    if (terms == 4) {
+        // The cubics of the splines, with the loop over the powers unrolled
+        const double* c0 = coefficients.data();
+        const double* c1 = c0 + pieces;
+        const double* c2 = c1 + pieces;
+        const double* c3 = c2 + pieces;
+        for (std::size_t k = 0; k < n; ++k) {
+            i = search.find_from(x_nodes, xs[k], i);
+            double t = xs[k] - x_nodes[i];
+            out[k] = c0[i] + t * (c1[i] + t * (c2[i] + t * c3[i]));
+        }
+        return;
+    }
+    for (std::size_t k = 0; k < n; ++k) {
+        i = search.find_from(x_nodes, xs[k], i);
+        double t = xs[k] - x_nodes[i];
+        double result = coefficient(terms - 1, i);
+        for (std::size_t p = terms - 1; p-- > 0;) {
+            result = result * t + coefficient(p, i);
+        }
+        out[k] = result;
+    }
+}
+
+PiecewisePolynomial PiecewisePolynomial::to_piecewise() const {
+    return *this;
+}
+
+PiecewisePolynomial PiecewisePolynomial::derivative(std::size_t order) const {
+    // d/dt c t^k = k c t^(k-1), applied `order` times
+    std::size_t new_terms = terms > order ? terms - order : 1;
+    std::vector<std::vector<double>> result(new_terms, std::vector<double>(pieces, 0.0));
+    if (terms > order) {
+        for (std::size_t k = 0; k < new_terms; ++k) {
+            double factor = 1.0;    // (k + 1) (k + 2) ... (k + order)
+            for (std::size_t m = 1; m <= order; ++m) {
+                factor *= static_cast<double>(k + m);
+            }
+            for (std::size_t i = 0; i < pieces; ++i) {
+                result[k][i] = factor * coefficient(k + order, i);
+            }
+        }
+    }
+    return PiecewisePolynomial(x_nodes, result);
+}
+
+double PiecewisePolynomial::partial_integral(std::size_t i, double t) const {
+    // sum_k c_k t^(k+1) / (k+1), by Horner's formula
+    double result = 0.0;
+    for (std::size_t k = terms; k-- > 0;) {
+        result = result * t + coefficient(k, i) / static_cast<double>(k + 1);
+    }
+    return result * t;
+}
+
+double PiecewisePolynomial::integral(double a, double b) const {
+    check_range(a);
+    check_range(b);
+    auto from_start = [this](double x) {
+        std::size_t i = search.find(x_nodes, x);
+        return cumulative[i] + partial_integral(i, x - x_nodes[i]);
+    };
+    return from_start(b) - from_start(a);
+}
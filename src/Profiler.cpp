@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include "Profiler.hpp"
+
+namespace {
+
+// a completed call, kept for the trace
+struct Event {
+    const char* operation;
+    double start_us;
+    double duration_us;
+    unsigned int thread;
+    std::vector<std::pair<const char*, double>> counters;
+};
+
+// bound the memory of the trace: the statistics keep counting past it
+constexpr std::size_t max_events = 1 << 20;
+
+std::atomic<bool> recording{false};
+
+std::mutex profile_mutex;
+std::map<std::string, Profiler::Stats, std::less<>> stats;
+std::vector<Event> events;
+std::size_t dropped_events{0};
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+// innermost open scope of the thread, which receives the counters
+thread_local Profiler::Scope* current_scope{nullptr};
+
+// small, stable thread numbers for the trace
+unsigned int thread_number()
+{
+    static std::atomic<unsigned int> next{0};
+    thread_local unsigned int number = next.fetch_add(1);
+    return number;
+}
+
+double microseconds(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+// operation and counter names are identifiers, but escape them anyway
+void write_json_string(std::ostream& out, std::string_view s)
+{
+    out << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << ' ';
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+std::ofstream open_output(const std::string& filename, const char* function)
+{
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error(std::string("ERROR in function ") + function + "(): could not open file: " + filename);
+    }
+    file << std::setprecision(15);
+    return file;
+}
+
+} // namespace
+
+bool Profiler::available()
+{
+#ifdef SCI_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::enable(bool on)
+{
+    recording.store(on && available());
+}
+
+bool Profiler::enabled()
+{
+    return recording.load(std::memory_order_relaxed);
+}
+
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    stats.clear();
+    events.clear();
+    dropped_events = 0;
+}
+
+std::map<std::string, Profiler::Stats> Profiler::report()
+{
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    return std::map<std::string, Stats>(stats.begin(), stats.end());
+}
+
+void Profiler::print(std::ostream& out)
+{
+    auto operations = report();
+    out << std::left << std::setw(24) << "Operation"
+        << std::setw(10) << "Calls"
+        << std::setw(14) << "Total (ms)"
+        << std::setw(14) << "Max (ms)" << "Counters\n";
+    out << std::string(82, '-') << "\n";
+    for (const auto& [operation, s] : operations) {
+        out << std::left << std::setw(24) << operation
+            << std::setw(10) << s.calls
+            << std::setw(14) << s.total_ms
+            << std::setw(14) << s.max_ms;
+        for (const auto& [counter, value] : s.counters) {
+            out << counter << "=" << value << " ";
+        }
+        out << "\n";
+    }
+}
+
+void Profiler::write_json(const std::string& filename)
+{
+    auto operations = report();
+    std::ofstream file = open_output(filename, "write_json");
+
+    file << "{\n";
+    bool first = true;
+    for (const auto& [operation, s] : operations) {
+        file << (first ? "" : ",\n") << "  ";
+        first = false;
+        write_json_string(file, operation);
+        file << ": {\"calls\": " << s.calls << ", \"total_ms\": " << s.total_ms
+             << ", \"max_ms\": " << s.max_ms << ", \"counters\": {";
+        bool first_counter = true;
+        for (const auto& [counter, value] : s.counters) {
+            file << (first_counter ? "" : ", ");
+            first_counter = false;
+            write_json_string(file, counter);
+            file << ": " << value;
+        }
+        file << "}}";
+    }
+    file << "\n}\n";
+}
+
+void Profiler::write_chrome_trace(const std::string& filename)
+{
+    std::ofstream file = open_output(filename, "write_chrome_trace");
+
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    file << "{\"displayTimeUnit\": \"ms\", \"droppedEvents\": " << dropped_events << ", \"traceEvents\": [\n";
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const Event& e = events[i];
+        file << "  {\"name\": ";
+        write_json_string(file, e.operation);
+        file << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+             << ", \"ts\": " << e.start_us << ", \"dur\": " << e.duration_us << ", \"args\": {";
+        for (std::size_t c = 0; c < e.counters.size(); ++c) {
+            file << (c == 0 ? "" : ", ");
+            write_json_string(file, e.counters[c].first);
+            file << ": " << e.counters[c].second;
+        }
+        file << "}}" << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    file << "]}\n";
+}
+
+void Profiler::count(const char* counter, double value)
+{
+    if (current_scope != nullptr) {
+        current_scope->count(counter, value);
+    }
+}
+
+Profiler::Scope::Scope(const char* operation)
+    : operation(operation), active(enabled())
+{
+    if (!active) {
+        return;
+    }
+    parent = current_scope;
+    current_scope = this;
+    start = std::chrono::steady_clock::now();
+}
+
+void Profiler::Scope::count(const char* counter, double value)
+{
+    if (!active) {
+        return;
+    }
+    for (auto& [name, total] : counters) {
+        if (name == counter || std::string_view(name) == counter) {
+            total += value;
+            return;
+        }
+    }
+    counters.emplace_back(counter, value);
+}
+
+Profiler::Scope::~Scope()
+{
+    if (!active) {
+        return;
+    }
+    auto end = std::chrono::steady_clock::now();
+    current_scope = parent;
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    std::lock_guard<std::mutex> lock(profile_mutex);
+    auto it = stats.find(std::string_view(operation));
+    if (it == stats.end()) {
+        it = stats.emplace(operation, Stats{}).first;
+    }
+    Stats& s = it->second;
+    s.calls += 1;
+    s.total_ms += ms;
+    s.max_ms = std::max(s.max_ms, ms);
+    for (const auto& [counter, value] : counters) {
+        s.counters[counter] += value;
+    }
+
+    if (events.size() < max_events) {
+        events.push_back(Event{operation, microseconds(start - epoch), microseconds(end - start), thread_number(), std::move(counters)});
+    } else {
+        ++dropped_events;
+    }
+}
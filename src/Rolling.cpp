@@ -0,0 +1,243 @@
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include "Rolling.hpp"
+
+Rolling::Rolling(std::vector<std::optional<double>> values, std::size_t window, std::size_t min_periods)
+    : values(std::move(values)), starts(this->values.size()), min_periods(min_periods)
+{
+    if (window == 0) {
+        throw std::invalid_argument("ERROR in function rolling(): the window must contain at least one row.");
+    }
+    drop_nan();
+    for (std::size_t row = 0; row < starts.size(); ++row) {
+        starts[row] = row + 1 >= window ? row + 1 - window : 0;
+    }
+}
+
+Rolling::Rolling(std::vector<std::optional<double>> values, const std::vector<double>& times, double duration, std::size_t min_periods)
+    : values(std::move(values)), starts(this->values.size()), min_periods(min_periods)
+{
+    if (times.size() != this->values.size()) {
+        throw std::invalid_argument("ERROR in function rolling(): one time per row is needed.");
+    }
+    if (!(duration > 0)) {
+        throw std::invalid_argument("ERROR in function rolling(): the duration must be positive.");
+    }
+    drop_nan();
+    // the windows only move forward: two pointers
+    std::size_t start{0};
+    for (std::size_t row = 0; row < times.size(); ++row) {
+        if (!std::isfinite(times[row])) {
+            throw std::invalid_argument("ERROR in function rolling(): the time column must be finite.");
+        }
+        if (row > 0 && !(times[row] >= times[row - 1])) {
+            throw std::invalid_argument("ERROR in function rolling(): the time column must be increasing.");
+        }
+        // a window always holds its own row, also when times[row] - duration
+        // rounds to times[row] (large times, small duration)
+        while (start < row && times[start] <= times[row] - duration) {
+            ++start;
+        }
+        starts[row] = start;
+    }
+}
+
+void Rolling::drop_nan()
+{
+    // a NaN would stay in the running sums after leaving the window, and it
+    // has no place in the ordered sets of the quantiles
+    for (auto& value : values) {
+        if (value && std::isnan(*value)) {
+            value.reset();
+        }
+    }
+}
+
+template <typename Add, typename Remove, typename Result>
+std::vector<std::optional<double>> Rolling::slide(Add add, Remove remove, Result result, std::size_t required) const
+{
+    std::vector<std::optional<double>> out;
+    out.reserve(values.size());
+    std::size_t first{0}, count{0};
+    for (std::size_t row = 0; row < values.size(); ++row) {
+        if (values[row]) {
+            add(*values[row]);
+            ++count;
+        }
+        for (; first < starts[row]; ++first) {
+            if (values[first]) {
+                remove(*values[first]);
+                --count;
+            }
+        }
+        if (count >= std::max(required, min_periods) && count > 0) {
+            out.emplace_back(result(count));
+        } else {
+            out.emplace_back(std::nullopt);
+        }
+    }
+    return out;
+}
+
+template <typename F>
+std::vector<std::optional<double>> Rolling::moments(F f, std::size_t required) const
+{
+    // Welford's update, and its inverse to remove the values leaving the window
+    std::size_t n{0};
+    double mean{0.0}, m2{0.0};
+    // length of the run of equal values ending at the last one added: when it
+    // covers the window the result is exact, without the rounding left by removals
+    std::size_t same{0};
+    double last{0.0};
+    auto add = [&](double x) {
+        same = (same > 0 && x == last) ? same + 1 : 1;
+        last = x;
+        ++n;
+        double delta = x - mean;
+        mean += delta / n;
+        m2 += delta * (x - mean);
+    };
+    auto remove = [&](double x) {
+        --n;
+        if (n == 0) {
+            mean = 0.0;
+            m2 = 0.0;
+            return;
+        }
+        double delta = x - mean;
+        mean -= delta / n;
+        m2 -= delta * (x - mean);
+    };
+    auto result = [&](std::size_t count) {
+        if (same >= count) {
+            return f(count, last, 0.0);
+        }
+        return f(count, mean, std::max(m2, 0.0));
+    };
+    return slide(add, remove, result, required);
+}
+
+std::vector<std::optional<double>> Rolling::sum() const
+{
+    // compensated (Neumaier) running sum: the error does not grow along the column
+    double sum{0.0}, compensation{0.0};
+    auto add = [&](double x) {
+        double t = sum + x;
+        compensation += std::fabs(sum) >= std::fabs(x) ? (sum - t) + x : (x - t) + sum;
+        sum = t;
+    };
+    auto remove = [&](double x) { add(-x); };
+    return slide(add, remove, [&](std::size_t) { return sum + compensation; }, 1);
+}
+
+std::vector<std::optional<double>> Rolling::mean() const
+{
+    return moments([](std::size_t, double mean, double) { return mean; }, 1);
+}
+
+std::vector<std::optional<double>> Rolling::var() const
+{
+    return moments([](std::size_t count, double, double m2) { return m2 / (count - 1); }, 2);
+}
+
+std::vector<std::optional<double>> Rolling::sd() const
+{
+    return moments([](std::size_t count, double, double m2) { return std::sqrt(m2 / (count - 1)); }, 2);
+}
+
+template <typename Compare>
+std::vector<std::optional<double>> Rolling::extremum(Compare compare) const
+{
+    // row indices whose values are monotonic from the front (the extremum) to the back:
+    // a value that can never become the extremum again is dropped when a better one arrives
+    std::deque<std::size_t> candidates;
+    std::vector<std::optional<double>> out;
+    out.reserve(values.size());
+    std::size_t first{0}, count{0};
+    for (std::size_t row = 0; row < values.size(); ++row) {
+        if (values[row]) {
+            while (!candidates.empty() && !compare(*values[candidates.back()], *values[row])) {
+                candidates.pop_back();
+            }
+            candidates.push_back(row);
+            ++count;
+        }
+        for (; first < starts[row]; ++first) {
+            if (values[first]) {
+                --count;
+            }
+        }
+        while (!candidates.empty() && candidates.front() < starts[row]) {
+            candidates.pop_front();
+        }
+        if (count >= min_periods && count > 0) {
+            out.emplace_back(*values[candidates.front()]);
+        } else {
+            out.emplace_back(std::nullopt);
+        }
+    }
+    return out;
+}
+
+std::vector<std::optional<double>> Rolling::min() const
+{
+    return extremum(std::less<double>());
+}
+
+std::vector<std::optional<double>> Rolling::max() const
+{
+    return extremum(std::greater<double>());
+}
+
+std::vector<std::optional<double>> Rolling::quantile(double q) const
+{
+    if (q < 0.0 || q > 1.0) {
+        throw std::invalid_argument("ERROR in function quantile(): the probability must be in [0, 1].");
+    }
+
+    // the lower set holds the values up to the rank floor(q * (count - 1)),
+    // so the two ranks to interpolate are the back of the lower set and the
+    // front of the upper one
+    std::multiset<double> lower, upper;
+    auto balance = [&](std::size_t count) {
+        std::size_t target = static_cast<std::size_t>(std::floor(q * (count - 1))) + 1;
+        while (lower.size() > target) {
+            auto last = std::prev(lower.end());
+            upper.insert(*last);
+            lower.erase(last);
+        }
+        while (lower.size() < target) {
+            lower.insert(*upper.begin());
+            upper.erase(upper.begin());
+        }
+    };
+    auto add = [&](double x) {
+        if (!lower.empty() && x <= *lower.rbegin()) {
+            lower.insert(x);
+        } else {
+            upper.insert(x);
+        }
+    };
+    auto remove = [&](double x) {
+        if (!lower.empty() && x <= *lower.rbegin()) {
+            lower.erase(lower.find(x));
+        } else {
+            upper.erase(upper.find(x));
+        }
+    };
+    auto result = [&](std::size_t count) {
+        balance(count);
+        double position = q * (count - 1);
+        double fraction = position - std::floor(position);
+        double low = *lower.rbegin();
+        if (upper.empty() || fraction == 0.0) {
+            return low;
+        }
+        return (1 - fraction) * low + fraction * *upper.begin();
+    };
+    return slide(add, remove, result, 1);
+}